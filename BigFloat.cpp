@@ -3,221 +3,1219 @@
 #include <algorithm>
 #include <cstring>
 #include <numeric>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <cmath>
+#include <system_error>
+#include <cerrno>
+#include <unistd.h>
 #include "BigFloat.h"
+#include "TaskPool.h"
 
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BIGFLOAT_X86_KERNELS
+#include <immintrin.h>
+#endif
 
-void BigFloat::addToIntPart(const std::vector<int> &digits) {
-    int carry = 0;
-    for(int i = 0; i < std::max(integerPart.size(), digits.size()); ++i) {
-        int anum = i < integerPart.size() && integerPart[i];
-        int bnum = i < digits.size() && digits[i];
-        integerPart[i] = (anum + bnum + carry) % base;
-        carry = (anum + bnum + carry) / base;
-    }
-    if(carry) integerPart.push_back(carry);
+static std::atomic<size_t> karatsubaThreshold{32};
+static std::atomic<size_t> toom3Threshold{512};
+static std::atomic<size_t> nttThreshold{1536};
+static std::atomic<size_t> parallelCutoffLimbs{512};
+//Tiers tuneMulThresholds is timing on the calling thread, which keeps its products serial meanwhile.
+//Other threads go on with the process-wide ones above
+static thread_local const BigFloatBase::MulThresholds *trialThresholds = nullptr;
+
+static size_t karatsubaCutoff() {
+    return trialThresholds ? trialThresholds->karatsuba : karatsubaThreshold.load(std::memory_order_relaxed);
+}
+static size_t toom3Cutoff() {
+    return trialThresholds ? trialThresholds->toom3 : toom3Threshold.load(std::memory_order_relaxed);
+}
+static size_t nttCutoff() {
+    return trialThresholds ? trialThresholds->ntt : nttThreshold.load(std::memory_order_relaxed);
 }
-//Following three functions are taken from https://habr.com/ru/articles/262705/
-void BigFloat::extend_vec(std::vector<int>& v, size_t len) {
-    while (len & (len - 1)) {
-        ++len;
+static size_t splitCutoff() {
+    return trialThresholds ? SIZE_MAX : parallelCutoffLimbs.load(std::memory_order_relaxed);
+}
+
+namespace {
+    //Chunks of the per-thread scratch arena, see BigFloatBase::Scratch
+    struct Arena {
+        std::vector<std::unique_ptr<uint32_t[]>> chunks;
+        std::vector<size_t> sizes;
+        size_t chunk = 0, offset = 0;
+    };
+    const size_t minArenaChunk = 1 << 14;
+    thread_local Arena arena;
+    thread_local uint64_t allocations = 0;
+
+    struct CounterCount : BigFloatBase {
+        static constexpr size_t value = static_cast<size_t>(Counter::Count);
+    };
+    const size_t counterCount = CounterCount::value;
+    //Statistics of one thread. Only the owner writes them, stats() reads them from any thread
+    struct ThreadStats {
+        std::atomic<uint64_t> counts[counterCount] = {};
+        std::atomic<uint64_t> ns[counterCount] = {};
+        unsigned depth[counterCount] = {};
+        ThreadStats();
+        ~ThreadStats();
+        void add(std::atomic<uint64_t> &value, uint64_t n) {
+            value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+    };
+    //Threads that gather statistics, with the totals of the ones that have exited
+    struct StatsRegistry {
+        std::mutex m;
+        std::vector<ThreadStats *> threads;
+        uint64_t counts[counterCount] = {}, ns[counterCount] = {};
+    };
+    //Never destroyed: pool workers may exit during static destruction
+    StatsRegistry &statsRegistry() {
+        static auto *registry = new StatsRegistry;
+        return *registry;
     }
+    ThreadStats::ThreadStats() {
+        StatsRegistry &registry = statsRegistry();
+        std::lock_guard<std::mutex> lock(registry.m);
+        registry.threads.push_back(this);
+    }
+    ThreadStats::~ThreadStats() {
+        StatsRegistry &registry = statsRegistry();
+        std::lock_guard<std::mutex> lock(registry.m);
+        for (size_t i = 0; i < counterCount; ++i) {
+            registry.counts[i] += counts[i].load(std::memory_order_relaxed);
+            registry.ns[i] += ns[i].load(std::memory_order_relaxed);
+        }
+        registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), this));
+    }
+    thread_local ThreadStats threadStats;
 
-    v.resize(len);
+    std::mutex sinkMutex;
+    std::function<void(const std::string &)> diagnosticSink;
 }
-std::vector<int> BigFloat::naive_mul(const std::vector<int>& x, const std::vector<int>& y) {
-    auto len = x.size();
-    std::vector<int> res(2 * len, 0);
 
-    for (auto i = 0; i < len; ++i) {
-        for (auto j = 0; j < len; ++j) {
-            res[i + j] += x[i] * y[j];
+//Writes the 9 zero-padded digits of a limb
+static void limbDigits(char *out, uint32_t limb) {
+    for(int i = 8; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + limb % 10);
+        limb /= 10;
+    }
+}
+//Base 10^9 limbs map to decimal digits one by one, so conversion is a single linear pass.
+//Digits are gathered in a fixed buffer that is handed to `flush` whenever it fills up
+template<class Flush>
+static void writeDigits(char sign, const uint32_t *limbs, size_t size, int fracLimbs, size_t precision, Flush flush) {
+    const size_t chunk = 1 << 16;
+    char buf[chunk];
+    size_t used = 0;
+    auto put = [&](const char *data, size_t n) {
+        if(used + n > chunk) {
+            flush(buf, used);
+            used = 0;
         }
+        memcpy(buf + used, data, n);
+        used += n;
+    };
+    if(sign) {
+        put("-", 1);
+    }
+    std::string top = std::to_string(limbs[size - 1]);
+    put(top.data(), top.size());
+    char digits[9];
+    for(size_t i = size - 1; i-- > static_cast<size_t>(fracLimbs);) {
+        limbDigits(digits, limbs[i]);
+        put(digits, 9);
+    }
+    put(".", 1);
+    size_t left = std::min(precision, static_cast<size_t>(fracLimbs) * 9);
+    for(int i = fracLimbs - 1; i >= 0 && left > 0; --i) {
+        size_t width = std::min<size_t>(left, 9);
+        limbDigits(digits, limbs[i]);
+        put(digits, width);
+        left -= width;
     }
+    flush(buf, used);
+}
 
+uint64_t BigFloatBase::allocationCount() {
+    return allocations;
+}
+void BigFloatBase::countAllocation() {
+    ++allocations;
+    if constexpr (statsEnabled) count(Counter::Allocation);
+}
+void BigFloatBase::count(Counter c) {
+    threadStats.add(threadStats.counts[static_cast<size_t>(c)], 1);
+}
+uint64_t BigFloatBase::StatsScope::enter(Counter c) {
+    auto i = static_cast<size_t>(c);
+    threadStats.add(threadStats.counts[i], 1);
+    if (threadStats.depth[i]++) {
+        return UINT64_MAX;
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+void BigFloatBase::StatsScope::leave(Counter c, uint64_t start) {
+    auto i = static_cast<size_t>(c);
+    --threadStats.depth[i];
+    if (start != UINT64_MAX) {
+        uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        threadStats.add(threadStats.ns[i], now - start);
+    }
+}
+BigFloatBase::Stats BigFloatBase::stats() {
+    Stats res;
+    if constexpr (!statsEnabled) {
+        return res;
+    }
+    StatsRegistry &registry = statsRegistry();
+    std::lock_guard<std::mutex> lock(registry.m);
+    uint64_t counts[counterCount], ns[counterCount];
+    std::copy(registry.counts, registry.counts + counterCount, counts);
+    std::copy(registry.ns, registry.ns + counterCount, ns);
+    for (ThreadStats *thread: registry.threads) {
+        for (size_t i = 0; i < counterCount; ++i) {
+            counts[i] += thread->counts[i].load(std::memory_order_relaxed);
+            ns[i] += thread->ns[i].load(std::memory_order_relaxed);
+        }
+    }
+    auto tier = [&](Counter c) { return Stats::Tier{counts[static_cast<size_t>(c)], ns[static_cast<size_t>(c)]}; };
+    res.naiveMul = tier(Counter::NaiveMul);
+    res.karatsubaMul = tier(Counter::KaratsubaMul);
+    res.toom3Mul = tier(Counter::Toom3Mul);
+    res.nttMul = tier(Counter::NttMul);
+    res.division = tier(Counter::Division);
+    res.sqrt = tier(Counter::Sqrt);
+    res.newtonSteps = counts[static_cast<size_t>(Counter::NewtonStep)];
+    res.carryPasses = counts[static_cast<size_t>(Counter::CarryPass)];
+    res.allocations = counts[static_cast<size_t>(Counter::Allocation)];
     return res;
 }
-std::vector<int> BigFloat::karatsuba_mul(const std::vector<int>& x, const std::vector<int>& y) {
-    auto len = x.size();
-    std::vector<int> res(2 * len);
+void BigFloatBase::resetStats() {
+    StatsRegistry &registry = statsRegistry();
+    std::lock_guard<std::mutex> lock(registry.m);
+    std::fill(registry.counts, registry.counts + counterCount, 0);
+    std::fill(registry.ns, registry.ns + counterCount, 0);
+    for (ThreadStats *thread: registry.threads) {
+        for (size_t i = 0; i < counterCount; ++i) {
+            thread->counts[i].store(0, std::memory_order_relaxed);
+            thread->ns[i].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+void BigFloatBase::setDiagnosticSink(std::function<void(const std::string &)> sink) {
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    diagnosticSink = std::move(sink);
+}
+void BigFloatBase::diagnostic(const std::string &message) {
+    std::function<void(const std::string &)> sink;
+    {
+        std::lock_guard<std::mutex> lock(sinkMutex);
+        sink = diagnosticSink;
+    }
+    if (sink) {
+        sink(message);
+    }
+}
+BigFloatBase::Scratch::Scratch() : chunk(arena.chunk), offset(arena.offset) {}
+BigFloatBase::Scratch::~Scratch() {
+    arena.chunk = chunk;
+    arena.offset = offset;
+}
+uint32_t *BigFloatBase::Scratch::alloc(size_t n) {
+    if(arena.chunk < arena.chunks.size() && arena.offset + n <= arena.sizes[arena.chunk]) {
+        uint32_t *res = arena.chunks[arena.chunk].get() + arena.offset;
+        arena.offset += n;
+        return res;
+    }
+    //Frames are released in LIFO order, so chunks past the current one are free and can be replaced
+    size_t next = arena.chunk < arena.chunks.size() ? arena.chunk + 1 : arena.chunk;
+    if(next == arena.chunks.size()) {
+        arena.chunks.emplace_back();
+        arena.sizes.push_back(0);
+    }
+    if(arena.sizes[next] < n) {
+        size_t size = std::max({n, minArenaChunk, next ? 2 * arena.sizes[next - 1] : 0});
+        arena.chunks[next].reset(new uint32_t[size]);
+        arena.sizes[next] = size;
+        countAllocation();
+    }
+    arena.chunk = next;
+    arena.offset = n;
+    return arena.chunks[next].get();
+}
+
+BigFloatBase::MulThresholds BigFloatBase::mulThresholds() {
+    return {karatsubaThreshold.load(), toom3Threshold.load(), nttThreshold.load()};
+}
+void BigFloatBase::setMulThresholds(MulThresholds thresholds) {
+    //Below 3 limbs the middle product of h + 1 limbs is no smaller than the operands and Karatsuba would not terminate
+    karatsubaThreshold = std::max<size_t>(thresholds.karatsuba, 3);
+    toom3Threshold = thresholds.toom3;
+    nttThreshold = thresholds.ntt;
+}
+
+unsigned BigFloatBase::workerCount() {
+    return TaskPool::instance().workers();
+}
+void BigFloatBase::setWorkerCount(unsigned workers) {
+    TaskPool::instance().setWorkers(workers);
+}
+size_t BigFloatBase::parallelCutoff() {
+    return parallelCutoffLimbs.load();
+}
+void BigFloatBase::setParallelCutoff(size_t limbs) {
+    parallelCutoffLimbs = limbs;
+}
+
+//Limb kernels for each instruction set. addProducts adds x * y to 64-bit columns, addLimbs and subLimbs return the
+//carry (borrow) out of n limbs. The vector versions resolve the carries of a whole register at once: a lane
+//generates a carry when its sum reaches base and propagates one when it is base - 1, and adding the propagate
+//mask to the shifted generate mask ripples every carry to its place in a single integer addition
+namespace {
+    BigFloatBase::Simd detectSimd() {
+#ifdef BIGFLOAT_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return BigFloatBase::Simd::AVX512;
+        if (__builtin_cpu_supports("avx2")) return BigFloatBase::Simd::AVX2;
+#endif
+        return BigFloatBase::Simd::Scalar;
+    }
+    //Scalar is zero, so kernels running before static initialisation take the portable path
+    const BigFloatBase::Simd supportedSimd = detectSimd();
+    std::atomic<BigFloatBase::Simd> simdLevel{supportedSimd};
+
+    const uint32_t limbBase = 1000000000;
+    //Products are below base^2, so 18 rows fit into a 64-bit column together with the carries
+    const size_t carryRows = 18;
+
+    void addProductsScalar(uint64_t *acc, const uint32_t *x, size_t n, uint32_t y) {
+        for (size_t i = 0; i < n; ++i) acc[i] += static_cast<uint64_t>(x[i]) * y;
+    }
+    uint32_t addScalar(uint32_t *res, const uint32_t *x, const uint32_t *y, size_t n, uint32_t carry) {
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t cur = x[i] + y[i] + carry;
+            carry = cur >= limbBase;
+            res[i] = carry ? cur - limbBase : cur;
+        }
+        return carry;
+    }
+    uint32_t subScalar(uint32_t *res, const uint32_t *x, const uint32_t *y, size_t n, uint32_t loan) {
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t bnum = y[i] + loan;
+            loan = x[i] < bnum;
+            res[i] = loan ? x[i] + limbBase - bnum : x[i] - bnum;
+        }
+        return loan;
+    }
 
-    if (len <= 100) { //This constant means that we will use native mult for small numbers (because of better constant)
-        return naive_mul(x, y);
+#ifdef BIGFLOAT_X86_KERNELS
+    //Bit i is the carry into lane i, bit `lanes` the carry out of the register
+    inline uint32_t rippleCarries(uint32_t generate, uint32_t propagate, uint32_t carry) {
+        uint32_t shifted = generate << 1 | carry;
+        return (shifted + propagate) ^ propagate;
     }
 
-    auto k = len / 2;
+    __attribute__((target("avx2")))
+    void addProductsAvx2(uint64_t *acc, const uint32_t *x, size_t n, uint32_t y) {
+        const __m256i factor = _mm256_set1_epi64x(y);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m256i limbs = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(x + i)));
+            __m256i *column = reinterpret_cast<__m256i *>(acc + i);
+            _mm256_storeu_si256(column, _mm256_add_epi64(_mm256_loadu_si256(column), _mm256_mul_epu32(limbs, factor)));
+        }
+        addProductsScalar(acc + i, x + i, n - i, y);
+    }
+    __attribute__((target("avx2")))
+    uint32_t addAvx2(uint32_t *res, const uint32_t *x, const uint32_t *y, size_t n, uint32_t carry) {
+        const __m256i top = _mm256_set1_epi32(limbBase - 1), baseV = _mm256_set1_epi32(limbBase);
+        const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i s = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i)),
+                                         _mm256_loadu_si256(reinterpret_cast<const __m256i *>(y + i)));
+            uint32_t generate = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(s, top)));
+            uint32_t propagate = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(s, top)));
+            uint32_t carries = rippleCarries(generate, propagate, carry);
+            carry = carries >> 8 & 1;
+            //Lanes with a carry in become -1, subtracting them adds the carry
+            __m256i in = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int>(carries)), bits), bits);
+            s = _mm256_sub_epi32(s, in);
+            s = _mm256_sub_epi32(s, _mm256_and_si256(_mm256_cmpgt_epi32(s, top), baseV));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(res + i), s);
+        }
+        return addScalar(res + i, x + i, y + i, n - i, carry);
+    }
+    __attribute__((target("avx2")))
+    uint32_t subAvx2(uint32_t *res, const uint32_t *x, const uint32_t *y, size_t n, uint32_t loan) {
+        const __m256i zero = _mm256_setzero_si256(), baseV = _mm256_set1_epi32(limbBase);
+        const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i d = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i)),
+                                         _mm256_loadu_si256(reinterpret_cast<const __m256i *>(y + i)));
+            uint32_t generate = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(zero, d)));
+            uint32_t propagate = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(d, zero)));
+            uint32_t loans = rippleCarries(generate, propagate, loan);
+            loan = loans >> 8 & 1;
+            __m256i in = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int>(loans)), bits), bits);
+            d = _mm256_add_epi32(d, in);
+            d = _mm256_add_epi32(d, _mm256_and_si256(_mm256_cmpgt_epi32(zero, d), baseV));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(res + i), d);
+        }
+        return subScalar(res + i, x + i, y + i, n - i, loan);
+    }
 
-    std::vector<int> Xr {x.begin(), x.begin() + k};
-    std::vector<int> Xl {x.begin() + k, x.end()};
-    std::vector<int> Yr {y.begin(), y.begin() + k};
-    std::vector<int> Yl {y.begin() + k, y.end()};
+    __attribute__((target("avx512f")))
+    void addProductsAvx512(uint64_t *acc, const uint32_t *x, size_t n, uint32_t y) {
+        const __m512i factor = _mm512_set1_epi64(y);
+        //The zero-masked forms with every lane selected are the same instructions; the plain ones pass GCC an
+        //undefined vector that -Wmaybe-uninitialized reports
+        const __mmask8 all = 0xFF;
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m512i limbs = _mm512_maskz_cvtepu32_epi64(all, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i)));
+            _mm512_storeu_si512(acc + i, _mm512_add_epi64(_mm512_loadu_si512(acc + i), _mm512_maskz_mul_epu32(all, limbs, factor)));
+        }
+        addProductsScalar(acc + i, x + i, n - i, y);
+    }
+    __attribute__((target("avx512f")))
+    uint32_t addAvx512(uint32_t *res, const uint32_t *x, const uint32_t *y, size_t n, uint32_t carry) {
+        const __m512i top = _mm512_set1_epi32(limbBase - 1), baseV = _mm512_set1_epi32(limbBase), one = _mm512_set1_epi32(1);
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m512i s = _mm512_add_epi32(_mm512_loadu_si512(x + i), _mm512_loadu_si512(y + i));
+            uint32_t carries = rippleCarries(_mm512_cmpgt_epu32_mask(s, top), _mm512_cmpeq_epi32_mask(s, top), carry);
+            carry = carries >> 16 & 1;
+            s = _mm512_mask_add_epi32(s, static_cast<__mmask16>(carries), s, one);
+            s = _mm512_mask_sub_epi32(s, _mm512_cmpgt_epu32_mask(s, top), s, baseV);
+            _mm512_storeu_si512(res + i, s);
+        }
+        return addScalar(res + i, x + i, y + i, n - i, carry);
+    }
+    __attribute__((target("avx512f")))
+    uint32_t subAvx512(uint32_t *res, const uint32_t *x, const uint32_t *y, size_t n, uint32_t loan) {
+        const __m512i zero = _mm512_setzero_si512(), baseV = _mm512_set1_epi32(limbBase), one = _mm512_set1_epi32(1);
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m512i xv = _mm512_loadu_si512(x + i), yv = _mm512_loadu_si512(y + i);
+            uint32_t loans = rippleCarries(_mm512_cmpgt_epu32_mask(yv, xv), _mm512_cmpeq_epi32_mask(xv, yv), loan);
+            loan = loans >> 16 & 1;
+            __m512i d = _mm512_mask_sub_epi32(_mm512_sub_epi32(xv, yv), static_cast<__mmask16>(loans), _mm512_sub_epi32(xv, yv), one);
+            d = _mm512_mask_add_epi32(d, _mm512_cmplt_epi32_mask(d, zero), d, baseV);
+            _mm512_storeu_si512(res + i, d);
+        }
+        return subScalar(res + i, x + i, y + i, n - i, loan);
+    }
+#endif
 
-    std::vector<int> P1 = karatsuba_mul(Xl, Yl);
-    std::vector<int> P2 = karatsuba_mul(Xr, Yr);
+    void addProducts(uint64_t *acc, const uint32_t *x, size_t n, uint32_t y) {
+#ifdef BIGFLOAT_X86_KERNELS
+        switch (simdLevel.load(std::memory_order_relaxed)) {
+            case BigFloatBase::Simd::AVX512: return addProductsAvx512(acc, x, n, y);
+            case BigFloatBase::Simd::AVX2: return addProductsAvx2(acc, x, n, y);
+            default: break;
+        }
+#endif
+        addProductsScalar(acc, x, n, y);
+    }
+    uint32_t addLimbs(uint32_t *res, const uint32_t *x, const uint32_t *y, size_t n, uint32_t carry) {
+#ifdef BIGFLOAT_X86_KERNELS
+        switch (simdLevel.load(std::memory_order_relaxed)) {
+            case BigFloatBase::Simd::AVX512: return addAvx512(res, x, y, n, carry);
+            case BigFloatBase::Simd::AVX2: return addAvx2(res, x, y, n, carry);
+            default: break;
+        }
+#endif
+        return addScalar(res, x, y, n, carry);
+    }
+    uint32_t subLimbs(uint32_t *res, const uint32_t *x, const uint32_t *y, size_t n, uint32_t loan) {
+#ifdef BIGFLOAT_X86_KERNELS
+        switch (simdLevel.load(std::memory_order_relaxed)) {
+            case BigFloatBase::Simd::AVX512: return subAvx512(res, x, y, n, loan);
+            case BigFloatBase::Simd::AVX2: return subAvx2(res, x, y, n, loan);
+            default: break;
+        }
+#endif
+        return subScalar(res, x, y, n, loan);
+    }
+    //Carries every column but the top one into [0, base)
+    void carryColumns(uint64_t *acc, size_t n) {
+        uint64_t carry = 0;
+        for (size_t k = 0; k + 1 < n; ++k) {
+            uint64_t v = acc[k] + carry;
+            acc[k] = v % limbBase;
+            carry = v / limbBase;
+        }
+        acc[n - 1] += carry;
+    }
+    //Moves what every column holds above base one column up without chaining the carries, so the columns are
+    //independent and pipeline. They end below base + 2^64 / base, small enough to take more rows
+    void relaxColumns(uint64_t *acc, size_t n) {
+        uint64_t high = 0;
+        for (size_t k = 0; k + 1 < n; ++k) {
+            uint64_t v = acc[k];
+            acc[k] = v % limbBase + high;
+            high = v / limbBase;
+        }
+        acc[n - 1] += high;
+    }
+}
 
-    std::vector<int> Xlr(k);
-    std::vector<int> Ylr(k);
+BigFloatBase::Simd BigFloatBase::simd() {
+    return simdLevel.load(std::memory_order_relaxed);
+}
+void BigFloatBase::setSimd(Simd level) {
+    simdLevel = std::min(level, supportedSimd);
+}
 
-    for (int i = 0; i < k; ++i) {
-        Xlr[i] = Xl[i] + Xr[i];
-        Ylr[i] = Yl[i] + Yr[i];
+//Rows x * y[r] go into 64-bit columns that are only carried every carryRows rows. The columns of a tile of x
+//live on the stack; once its rows are in, the low ones are final and the top yn move down for the next tile
+void BigFloatBase::naive_mul(uint32_t *res, const uint32_t *x, size_t xn, const uint32_t *y, size_t yn) {
+    const size_t tile = 256, maxRows = 32;
+    if (xn < yn) {
+        std::swap(x, y);
+        std::swap(xn, yn);
+    }
+    if (yn > maxRows) {
+        //Products with slices of y are added up
+        naive_mul(res, x, xn, y, maxRows);
+        std::fill(res + xn + maxRows, res + xn + yn, 0);
+        Scratch scratch;
+        uint32_t *part = scratch.alloc(xn + maxRows);
+        for (size_t s = maxRows; s < yn; s += maxRows) {
+            size_t m = std::min(maxRows, yn - s);
+            naive_mul(part, x, xn, y + s, m);
+            sum(res + s, res + s, xn + yn - s, part, xn + m);
+        }
+        return;
+    }
+    StatsScope scope(Counter::NaiveMul);
+    uint64_t acc[tile + maxRows];
+    std::fill(acc, acc + yn, 0);
+    for (size_t i0 = 0; i0 < xn; i0 += tile) {
+        size_t t = std::min(tile, xn - i0), width = t + yn;
+        std::fill(acc + yn, acc + width, 0);
+        size_t rows = 0;
+        for (size_t r = 0; r < yn; ++r) {
+            if (y[r] == 0) {
+                continue;
+            }
+            if (rows++ == carryRows) {
+                if constexpr (statsEnabled) count(Counter::CarryPass);
+                carryColumns(acc, width);
+                rows = 1;
+            }
+            addProducts(acc + r, x + i0, t, y[r]);
+        }
+        if constexpr (statsEnabled) count(Counter::CarryPass);
+        carryColumns(acc, width);
+        std::copy(acc, acc + t, res + i0);
+        std::copy(acc + t, acc + width, acc);
+    }
+    std::copy(acc, acc + yn, res + xn);
+}
+//x[i] x[j] for i < j appears twice in the square, so row i multiplies x[i] by the doubled limbs past it and the
+//squares x[i]^2 start the columns: about half the products of naive_mul. A column takes below base^2 from its
+//square and below 2 base^2 per row, so the columns are relaxed every sqrRows rows and carried once at the end.
+//Squares past maxLimbs, far beyond any Karatsuba cutoff, go to naive_mul to keep the columns on the stack
+void BigFloatBase::naive_sqr(uint32_t *res, const uint32_t *x, size_t n) {
+    const size_t maxLimbs = 128, sqrRows = (carryRows - 2) / 2;
+    if (n > maxLimbs) {
+        naive_mul(res, x, n, x, n);
+        return;
     }
+    StatsScope scope(Counter::NaiveMul);
+    //Limbs up to row i are zeroed as the rows pass them, so a row may start early at a multiple of the vector width
+    uint32_t doubled[maxLimbs];
+    uint64_t acc[2 * maxLimbs];
+    for (size_t i = 0; i < n; ++i) {
+        doubled[i] = 2 * x[i];
+        acc[2 * i] = static_cast<uint64_t>(x[i]) * x[i];
+        acc[2 * i + 1] = 0;
+    }
+    size_t rows = 0;
+    for (size_t i = 0; i + 1 < n; ++i) {
+        doubled[i] = 0;
+        if (x[i] == 0) {
+            continue;
+        }
+        if (rows++ == sqrRows) {
+            relaxColumns(acc, 2 * n);
+            rows = 1;
+        }
+        size_t first = (i + 1) & ~size_t(7);
+        addProducts(acc + i + first, doubled + first, n - first, x[i]);
+    }
+    if constexpr (statsEnabled) count(Counter::CarryPass);
+    carryColumns(acc, 2 * n);
+    std::copy(acc, acc + 2 * n, res);
+}
+//Algorithm is taken from https://habr.com/ru/articles/262705/
+//P2 and P1 are written straight into the two halves of res, the middle product lives in scratch memory
+void BigFloatBase::karatsuba_mul(uint32_t *res, const uint32_t *x, const uint32_t *y, size_t len) {
+    if (len <= karatsubaCutoff()) { //Naive mult is faster for small numbers (because of better constant)
+        balanced_mul(res, x, y, len);
+        return;
+    }
+    StatsScope scope(Counter::KaratsubaMul);
 
-    std::vector<int> P3 = karatsuba_mul(Xlr, Ylr);
+    size_t k = len / 2, h = len - k;
+    Scratch scratch;
+    //A square has squares for subproducts, the sums of halves are shared
+    uint32_t *Xlr = scratch.alloc(h + 1);
+    uint32_t *Ylr = x == y ? Xlr : scratch.alloc(h + 1);
+    uint32_t *P3 = scratch.alloc(2 * (h + 1));
 
-    for (auto i = 0; i < len; ++i) {
-        P3[i] -= P2[i] + P1[i];
+    //Sums of halves may carry into one more limb
+    Xlr[h] = sum(Xlr, x + k, h, x, k);
+    if (x != y) {
+        Ylr[h] = sum(Ylr, y + k, h, y, k);
     }
 
-    for (auto i = 0; i < len; ++i) {
-        res[i] = P2[i];
+    if (len >= splitCutoff()) {
+        //The three subproducts are independent, P2 and P1 are offered to idle workers
+        auto P2 = TaskPool::task([=] { balanced_mul(res, x, y, k); });
+        auto P1 = TaskPool::task([=] { balanced_mul(res + 2 * k, x + k, y + k, h); });
+        TaskPool::Group group;
+        group.fork(P2);
+        group.fork(P1);
+        balanced_mul(P3, Xlr, Ylr, h + 1);
+        group.join();
+    } else {
+        balanced_mul(res, x, y, k);
+        balanced_mul(res + 2 * k, x + k, y + k, h);
+        balanced_mul(P3, Xlr, Ylr, h + 1);
     }
 
-    for (auto i = len; i < 2 * len; ++i) {
-        res[i] = P1[i - len];
+    substract(P3, P3, 2 * (h + 1), res, 2 * k);
+    substract(P3, P3, 2 * (h + 1), res + 2 * k, 2 * h);
+    //Limbs of P3 past the end of res are zero
+    sum(res + k, res + k, 2 * len - k, P3, std::min(2 * (h + 1), 2 * len - k));
+}
+//Toom-Cook 3: x = x0 + x1 B + x2 B^2 for B = base^k and the same for y, so the product is a polynomial of degree 4
+//in B fixed by its values at 0, 1, 2, 3 and infinity. Five products of k + 1 limbs replace the nine of schoolbook
+//splitting. With nonnegative points every step of the interpolation stays nonnegative, so unsigned limbs and exact
+//divisions by 2 and 3 are all it takes
+void BigFloatBase::toom3_mul(uint32_t *res, const uint32_t *x, const uint32_t *y, size_t len) {
+    //Short operands leave x2 empty
+    const size_t minLimbs = 9;
+    if (len < minLimbs) {
+        karatsuba_mul(res, x, y, len);
+        return;
+    }
+    StatsScope scope(Counter::Toom3Mul);
+    size_t k = (len + 2) / 3, l2 = len - 2 * k, w = 2 * k + 2;
+    //value = v0 + t v1 + t^2 v2 over k + 1 limbs by Horner's rule
+    auto evaluate = [=](uint32_t *value, const uint32_t *v, uint32_t t) {
+        std::copy(v + 2 * k, v + 2 * k + l2, value);
+        std::fill(value + l2, value + k + 1, 0);
+        for (const uint32_t *part: {v + k, v}) {
+            if (t > 1) {
+                mulBySmall(value, value, k + 1, t);
+            }
+            sum(value, value, k + 1, part, k);
+        }
+    };
+    Scratch scratch;
+    uint32_t *ex[3], *ey[3], *r[3];
+    for (uint32_t t = 0; t < 3; ++t) {
+        ex[t] = scratch.alloc(k + 1);
+        ey[t] = x == y ? ex[t] : scratch.alloc(k + 1);
+        r[t] = scratch.alloc(w);
+        evaluate(ex[t], x, t + 1);
+        if (x != y) {
+            evaluate(ey[t], y, t + 1);
+        }
+    }
+    //The values at 0 and infinity are the low and high ends of the product, they go straight into res
+    uint32_t *r0 = res, *rInf = res + 4 * k;
+    if (len >= splitCutoff()) {
+        auto P0 = TaskPool::task([=] { balanced_mul(r0, x, y, k); });
+        auto PInf = TaskPool::task([=] { balanced_mul(rInf, x + 2 * k, y + 2 * k, l2); });
+        auto P1 = TaskPool::task([&] { balanced_mul(r[0], ex[0], ey[0], k + 1); });
+        auto P2 = TaskPool::task([&] { balanced_mul(r[1], ex[1], ey[1], k + 1); });
+        //P1 and P2 read r, ex and ey from this frame, the group joins all four before an error can leave it
+        TaskPool::Group group;
+        group.fork(P0);
+        group.fork(PInf);
+        group.fork(P1);
+        group.fork(P2);
+        balanced_mul(r[2], ex[2], ey[2], k + 1);
+        group.join();
+    } else {
+        balanced_mul(r0, x, y, k);
+        balanced_mul(rInf, x + 2 * k, y + 2 * k, l2);
+        for (int t = 0; t < 3; ++t) {
+            balanced_mul(r[t], ex[t], ey[t], k + 1);
+        }
     }
 
-    for (auto i = k; i < len + k; ++i) {
-        res[i] += P3[i - k];
+    //s_t = (r_t - r0 - t^4 rInf) / t = c1 + c2 t + c3 t^2
+    uint32_t *tmp = scratch.alloc(w);
+    for (uint32_t t = 1; t <= 3; ++t) {
+        uint32_t *s = r[t - 1];
+        substract(s, s, w, r0, 2 * k);
+        std::fill(tmp, tmp + w, 0);
+        tmp[2 * l2] = mulBySmall(tmp, rInf, 2 * l2, t * t * t * t);
+        substract(s, s, w, tmp, 2 * l2 + 1);
+        if (t > 1) {
+            divideBySmall(s, w, t);
+        }
     }
+    uint32_t *c1 = r[0], *c2 = r[1], *c3 = r[2];
+    //s3 - s2 = c2 + 5 c3, s2 - s1 = c2 + 3 c3
+    substract(c3, c3, w, c2, w);
+    substract(c2, c2, w, c1, w);
+    substract(c3, c3, w, c2, w);
+    divideBySmall(c3, w, 2);
+    mulBySmall(tmp, c3, w, 3);
+    substract(c2, c2, w, tmp, w);
+    substract(c1, c1, w, c2, w);
+    substract(c1, c1, w, c3, w);
 
-    return res;
+    std::fill(res + 2 * k, res + 4 * k, 0);
+    for (size_t i = 1; i <= 3; ++i) {
+        //Limbs of c_i past the end of res are zero
+        size_t at = i * k;
+        sum(res + at, res + at, 2 * len - at, r[i - 1], std::min(w, 2 * len - at));
+    }
+}
+void BigFloatBase::balanced_mul(uint32_t *res, const uint32_t *x, const uint32_t *y, size_t len) {
+    if (len <= karatsubaCutoff()) {
+        if (x == y) {
+            naive_sqr(res, x, len);
+        } else {
+            naive_mul(res, x, len, y, len);
+        }
+    } else if (len >= toom3Cutoff()) {
+        toom3_mul(res, x, y, len);
+    } else {
+        karatsuba_mul(res, x, y, len);
+    }
 }
-void BigFloat::finalize(std::vector<int>& res) {
-    int i = 0;
-    for (; i < res.size() - 1; ++i) {
-        res[i + 1] += res[i] / base;
-        res[i] %= base;
+void BigFloatBase::mult(uint32_t *res, const uint32_t *x, size_t xn, const uint32_t *y, size_t yn) {
+    if (xn < yn) {
+        std::swap(x, y);
+        std::swap(xn, yn);
+    }
+    if (yn >= nttCutoff()) {
+        ntt_mul(res, x, xn, y, yn);
+        return;
+    }
+    if (xn == yn) {
+        balanced_mul(res, x, y, xn);
+        return;
     }
-    while(res[i] >= base) {
-        res.push_back(res[i] / base);
-        res[i] %= base;
-        ++i;
+    if (yn <= karatsubaCutoff()) {
+        naive_mul(res, x, xn, y, yn);
+        return;
+    }
+    //The longer operand is cut into blocks of yn limbs, each one a balanced product with y added at its offset,
+    //so a lopsided product costs about xn / yn balanced ones of the short length
+    Scratch scratch;
+    uint32_t *part = scratch.alloc(2 * yn);
+    balanced_mul(res, x, y, yn);
+    size_t s = yn;
+    for (; s < xn; s += yn) {
+        size_t m = std::min(yn, xn - s);
+        if (m == yn) {
+            balanced_mul(part, x + s, y, yn);
+        } else {
+            mult(part, y, yn, x + s, m);
+        }
+        //The top yn limbs written so far overlap the low half of the block, the rest is new
+        uint32_t carry = sum(res + s, res + s, yn, part, yn);
+        std::copy(part + yn, part + yn + m, res + s + yn);
+        sum(res + s + yn, res + s + yn, m, &carry, 1);
     }
 }
-std::vector<int> BigFloat::mult(std::vector<int>& x, std::vector<int>& y) {
-    extend_vec(x, y.size());
-    extend_vec(y, x.size());
+//Number-theoretic transform modulo three NTT-friendly primes. A convolution of base 10^9 limbs has
+//coefficients below min(n, m) * 10^18 < 2^22 * 10^18, well under the product of the primes (~7.9e25),
+//so the CRT reconstruction is exact and the result is identical to the Karatsuba one.
+namespace {
+    const uint32_t nttPrimes[3] = {998244353, 167772161, 469762049};
+    const uint32_t nttRoot = 3; //Primitive root of all three primes
+    const size_t maxNttLength = size_t(1) << 23;
 
-    std::vector<int> res = karatsuba_mul(x, y);
-    finalize(res);
-    return res;
+    uint32_t powMod(uint64_t a, uint64_t e, uint32_t p) {
+        uint64_t res = 1;
+        for (a %= p; e; e >>= 1, a = a * a % p) {
+            if (e & 1) res = res * a % p;
+        }
+        return res;
+    }
+    void ntt(uint32_t *a, size_t n, uint32_t p, bool inverse, uint32_t *roots) {
+        for (size_t i = 1, j = 0; i < n; ++i) {
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1) j ^= bit;
+            j ^= bit;
+            if (i < j) std::swap(a[i], a[j]);
+        }
+        for (size_t len = 2; len <= n; len <<= 1) {
+            uint64_t w = powMod(nttRoot, (p - 1) / len, p);
+            if (inverse) w = powMod(w, p - 2, p);
+            size_t half = len / 2;
+            roots[0] = 1;
+            for (size_t i = 1; i < half; ++i) roots[i] = roots[i - 1] * w % p;
+            for (size_t i = 0; i < n; i += len) {
+                for (size_t j = 0; j < half; ++j) {
+                    uint32_t u = a[i + j];
+                    uint32_t v = static_cast<uint64_t>(a[i + j + half]) * roots[j] % p;
+                    a[i + j] = u + v >= p ? u + v - p : u + v;
+                    a[i + j + half] = u >= v ? u - v : u + p - v;
+                }
+            }
+        }
+        if (inverse) {
+            uint64_t nInv = powMod(n, p - 2, p);
+            for (size_t i = 0; i < n; ++i) a[i] = a[i] * nInv % p;
+        }
+    }
+    //Cyclic convolution of x and y modulo p into fx, fy and roots are n and n / 2 limbs of scratch.
+    //A square transforms its operand once
+    void convolution(uint32_t *fx, uint32_t *fy, uint32_t *roots, const uint32_t *x, size_t xn, const uint32_t *y, size_t yn, size_t n, uint32_t p) {
+        std::copy(x, x + xn, fx);
+        std::fill(fx + xn, fx + n, 0);
+        ntt(fx, n, p, false, roots);
+        if (x == y && xn == yn) {
+            fy = fx;
+        } else {
+            std::copy(y, y + yn, fy);
+            std::fill(fy + yn, fy + n, 0);
+            ntt(fy, n, p, false, roots);
+        }
+        for (size_t i = 0; i < n; ++i) fx[i] = static_cast<uint64_t>(fx[i]) * fy[i] % p;
+        ntt(fx, n, p, true, roots);
+    }
 }
-std::vector<int> BigFloat::sum(const std::vector<int> &x, const std::vector<int> &y) {
-    std::vector<int> res(std::max(x.size(), y.size()));
-    int carry = 0;
-    for(int i = 0; i < std::max(x.size(), y.size()); ++i) {
-        int anum = i < x.size() ? x[i] : 0;
-        int bnum = i < y.size() ? y[i] : 0;
-        res[i] = (anum + bnum + carry) % base;
-        carry = (anum + bnum + carry) / base;
+void BigFloatBase::ntt_mul(uint32_t *res, const uint32_t *x, size_t xn, const uint32_t *y, size_t yn) {
+    StatsScope scope(Counter::NttMul);
+    size_t resLen = xn + yn;
+    size_t n = 1;
+    while (n < resLen) n <<= 1;
+    if (n > maxNttLength) {
+        throw std::length_error("BigFloat: operands are too long for the NTT multiplication");
     }
-    if(carry) res.push_back(carry);
-    return res;
+    Scratch scratch;
+    uint32_t *r[3], *fy[3], *roots[3];
+    for (int t = 0; t < 3; ++t) {
+        r[t] = scratch.alloc(n);
+        fy[t] = scratch.alloc(n);
+        roots[t] = scratch.alloc(n / 2);
+    }
+    //Convolutions modulo different primes are independent
+    auto modulo = [&](int t) {
+        return TaskPool::task([=] { convolution(r[t], fy[t], roots[t], x, xn, y, yn, n, nttPrimes[t]); });
+    };
+    auto second = modulo(1), third = modulo(2);
+    if (yn >= splitCutoff()) {
+        TaskPool::Group group;
+        group.fork(second);
+        group.fork(third);
+        modulo(0).run();
+        group.join();
+    } else {
+        modulo(0).run();
+        second.run();
+        third.run();
+    }
+
+    //Garner's CRT: value = r0 + p0 * (k1 + p1 * k2)
+    const uint64_t p0 = nttPrimes[0], p1 = nttPrimes[1], p2 = nttPrimes[2];
+    const uint64_t inv01 = powMod(p0, p1 - 2, p1);
+    const uint64_t inv012 = powMod(p0 * p1 % p2, p2 - 2, p2);
+    unsigned __int128 carry = 0;
+    for (size_t i = 0; i < resLen; ++i) {
+        uint64_t k1 = (r[1][i] + p1 - r[0][i] % p1) % p1 * inv01 % p1;
+        uint64_t x01 = r[0][i] + p0 * k1;
+        uint64_t k2 = (r[2][i] + p2 - x01 % p2) % p2 * inv012 % p2;
+        unsigned __int128 cur = static_cast<unsigned __int128>(p0 * p1) * k2 + x01 + carry;
+        res[i] = cur % base;
+        carry = cur / base;
+    }
+}
+//Each crossover is the first size of a ladder where the next tier beats the current one, timed single-threaded with
+//the thresholds found so far: naive against one Karatsuba level, Karatsuba against one Toom-3 level, then the
+//resulting recursion against the transform
+BigFloatBase::MulThresholds BigFloatBase::tuneMulThresholds() {
+    using clock = std::chrono::steady_clock;
+    const size_t maxLen = 8192;
+    std::vector<uint32_t> x(maxLen), y(maxLen), res(2 * maxLen);
+    uint64_t seed = 1;
+    for (size_t i = 0; i < maxLen; ++i) {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        x[i] = (seed >> 32) % base;
+        y[i] = (seed >> 8) % base;
+    }
+    //Best time of a few batches, a batch repeats short products so the clock resolution does not matter
+    auto timeOf = [](size_t len, const std::function<void()> &op) {
+        size_t reps = std::max<size_t>(1, 20000 / (len * len));
+        double best = 1e300;
+        auto start = clock::now();
+        for (int i = 0; i < 3 || clock::now() - start < std::chrono::milliseconds(2); ++i) {
+            auto batchStart = clock::now();
+            for (size_t j = 0; j < reps; ++j) {
+                op();
+            }
+            best = std::min(best, std::chrono::duration<double>(clock::now() - batchStart).count());
+        }
+        return best;
+    };
+    //First size where `faster` wins, `none` if it never does
+    auto crossover = [&](std::initializer_list<size_t> ladder, size_t none, const std::function<void(size_t)> &current,
+                         const std::function<void(size_t)> &faster) {
+        for (size_t len: ladder) {
+            if (timeOf(len, [&] { faster(len); }) < timeOf(len, [&] { current(len); })) {
+                return len;
+            }
+        }
+        return none;
+    };
+    MulThresholds trial{SIZE_MAX, SIZE_MAX, SIZE_MAX};
+    struct Trial {
+        explicit Trial(const MulThresholds &t) { trialThresholds = &t; }
+        ~Trial() { trialThresholds = nullptr; }
+    } scope(trial);
+    MulThresholds tuned{SIZE_MAX, SIZE_MAX, SIZE_MAX};
+
+    //Karatsuba takes over above the last size naive_mul wins at
+    size_t karatsuba = crossover({8, 12, 16, 20, 24, 32, 40, 48, 64, 96, 128}, 129,
+        [&](size_t len) { naive_mul(res.data(), x.data(), len, y.data(), len); },
+        [&](size_t len) {
+            trial.karatsuba = len - 1;
+            karatsuba_mul(res.data(), x.data(), y.data(), len);
+            trial.karatsuba = SIZE_MAX;
+        });
+    tuned.karatsuba = karatsuba - 1;
+    trial.karatsuba = tuned.karatsuba;
+    tuned.toom3 = crossover({64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048}, SIZE_MAX,
+        [&](size_t len) { karatsuba_mul(res.data(), x.data(), y.data(), len); },
+        [&](size_t len) {
+            trial.toom3 = len;
+            toom3_mul(res.data(), x.data(), y.data(), len);
+            trial.toom3 = SIZE_MAX;
+        });
+    trial.toom3 = tuned.toom3;
+    tuned.ntt = crossover({256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096, 6144, maxLen}, SIZE_MAX,
+        [&](size_t len) { balanced_mul(res.data(), x.data(), y.data(), len); },
+        [&](size_t len) { ntt_mul(res.data(), x.data(), len, y.data(), len); });
+    return tuned;
 }
-std::vector<int> BigFloat::substract(const std::vector<int> &x, const std::vector<int> &y) {
-    std::vector<int> res(std::max(x.size(), y.size()));
-    int loan = 0;
-    for(int i = 0; i < std::max(x.size(), y.size()); ++i) {
-        int anum = i < x.size() ? x[i] : 0;
-        int bnum = i < y.size() ? y[i] : 0;
-        if(anum - loan >= bnum) {
-            res[i] = anum - loan - bnum;
+uint32_t BigFloatBase::sum(uint32_t *res, const uint32_t *x, size_t xn, const uint32_t *y, size_t yn) {
+    if (xn < yn) {
+        std::swap(x, y);
+        std::swap(xn, yn);
+    }
+    uint32_t carry = addLimbs(res, x, y, yn, 0);
+    for(size_t i = yn; i < xn; ++i) {
+        uint32_t cur = x[i] + carry;
+        carry = cur >= base;
+        res[i] = carry ? cur - base : cur;
+    }
+    return carry;
+}
+uint32_t BigFloatBase::substract(uint32_t *res, const uint32_t *x, size_t xn, const uint32_t *y, size_t yn) {
+    size_t n = std::min(xn, yn);
+    uint32_t loan = subLimbs(res, x, y, n, 0);
+    for(size_t i = n; i < xn; ++i) {
+        uint32_t anum = x[i];
+        uint32_t bnum = loan;
+        if(anum >= bnum) {
+            res[i] = anum - bnum;
             loan = 0;
         } else {
-            res[i] = anum - loan + base - bnum;
+            res[i] = anum + base - bnum;
             loan = 1;
         }
     }
-    if(loan) {
-        return substract(y, x);
+    return loan;
+}
+int BigFloatBase::compare(const uint32_t *x, size_t xn, const uint32_t *y, size_t yn) {
+    for(size_t i = std::max(xn, yn); i-- > 0;) {
+        uint32_t anum = i < xn ? x[i] : 0;
+        uint32_t bnum = i < yn ? y[i] : 0;
+        if(anum != bnum) {
+            return anum < bnum ? -1 : 1;
+        }
     }
-    return res;
+    return 0;
 }
-void BigFloat::addToFracPart(const std::vector<int> &digits) {
-    int carry = 0;
-    for(int i = 0; i < std::max(fractionalPart.size(), digits.size()); ++i) {
-        int anum = i < fractionalPart.size() && fractionalPart[i];
-        int bnum = i < digits.size() && digits[i];
-        fractionalPart[i] = (anum + bnum + carry) % base;
-        carry = (anum + bnum + carry) / base;
+uint32_t BigFloatBase::mulBySmall(uint32_t *res, const uint32_t *x, size_t n, uint32_t y) {
+    uint64_t carry = 0;
+    for(size_t i = 0; i < n; ++i) {
+        uint64_t cur = static_cast<uint64_t>(x[i]) * y + carry;
+        res[i] = cur % base;
+        carry = cur / base;
     }
-    if(carry) fractionalPart.push_back(carry);
+    return carry;
 }
-void BigFloat::normalise() {
-    if(fractionalPart.size() > BigFloat::sizeOfFracPart) {
-        addToIntPart(std::vector<int>(fractionalPart.begin() + BigFloat::sizeOfFracPart, fractionalPart.end()));
-        fractionalPart.resize(BigFloat::sizeOfFracPart);
+uint32_t BigFloatBase::divideBySmall(uint32_t *x, size_t n, uint32_t y) {
+    uint64_t remainder = 0;
+    for(size_t i = n; i-- > 0;) {
+        uint64_t cur = x[i] + remainder * base;
+        x[i] = cur / y;
+        remainder = cur % y;
     }
+    return remainder;
 }
-void BigFloat::divideByTwo(std::vector<int> &digits, bool remove_leading_zeroes) {
-    //https://ru.wikipedia.org/wiki/%D0%94%D0%B5%D0%BB%D0%B5%D0%BD%D0%B8%D0%B5_%D0%BD%D0%B0_%D0%B4%D0%B2%D0%B0
-    std::vector<int> res;
-    int last_nonzero = 0;
-    for(int i = 0; i < digits.size() - 1; ++i) {
-        if(digits[i+1] % 2 == 0) {
-            res.push_back(digits[i] / 2);
-            last_nonzero = digits[i] / 2 != 0 ? i : last_nonzero;
-        }
-        else{
-            res.push_back(5 + digits[i] / 2);
-            last_nonzero = i;
-        }
+//Products and running remainders of a limb and a 64-bit word need 128 bits, words below base stay in 64-bit arithmetic
+uint64_t BigFloatBase::mulByWord(uint32_t *res, const uint32_t *x, size_t n, uint64_t y) {
+    if(y < base) {
+        return mulBySmall(res, x, n, static_cast<uint32_t>(y));
+    }
+    uint64_t carry = 0;
+    for(size_t i = 0; i < n; ++i) {
+        unsigned __int128 cur = static_cast<unsigned __int128>(x[i]) * y + carry;
+        res[i] = cur % base;
+        carry = cur / base;
+    }
+    return carry;
+}
+uint64_t BigFloatBase::divideByWord(uint32_t *x, size_t n, uint64_t y) {
+    if(y < base) {
+        return divideBySmall(x, n, static_cast<uint32_t>(y));
     }
-    res.push_back(digits.back() / 2);
-    if(digits[digits.size() - 1] / 2 != 0) {
-        last_nonzero = digits.size() - 1;
+    uint64_t remainder = 0;
+    for(size_t i = n; i-- > 0;) {
+        unsigned __int128 cur = static_cast<unsigned __int128>(remainder) * base + x[i];
+        x[i] = cur / y;
+        remainder = cur % y;
     }
-    if(remove_leading_zeroes)
-        res.resize(last_nonzero + 1);
-    std::swap(digits, res);
+    return remainder;
 }
-void BigFloat::divideByTwo() {
-    std::vector<int> res;
-    bool divByTwo = true;
-    if(integerPart[0] % 2) {
-        divByTwo = false;
 
+void BigFloatBase::trim(LimbVector &digits) {
+    while(digits.size() > 1 && digits.back() == 0) digits.pop_back();
+}
+BigFloatBase::LimbVector BigFloatBase::sum(const LimbVector &x, const LimbVector &y) {
+    LimbVector res(std::max(x.size(), y.size()));
+    uint32_t carry = sum(res.data(), x.data(), x.size(), y.data(), y.size());
+    if(carry) res.push_back(carry);
+    return res;
+}
+//Returns |x - y|
+BigFloatBase::LimbVector BigFloatBase::substract(const LimbVector &x, const LimbVector &y) {
+    bool less = compare(x, y) < 0;
+    const LimbVector &a = less ? y : x;
+    const LimbVector &b = less ? x : y;
+    LimbVector res(a.size());
+    substract(res.data(), a.data(), a.size(), b.data(), std::min(a.size(), b.size()));
+    return res;
+}
+int BigFloatBase::compare(const LimbVector &x, const LimbVector &y) {
+    return compare(x.data(), x.size(), y.data(), y.size());
+}
+BigFloatBase::LimbVector BigFloatBase::mulLimbs(const LimbVector &x, const LimbVector &y) {
+    LimbVector res(x.size() + y.size());
+    mult(res.data(), x.data(), x.size(), y.data(), y.size());
+    trim(res);
+    return res;
+}
+BigFloatBase::LimbVector BigFloatBase::mulBySmall(const LimbVector &x, uint32_t y) {
+    LimbVector res(x.size());
+    uint32_t carry = mulBySmall(res.data(), x.data(), x.size(), y);
+    if(carry) res.push_back(carry);
+    return res;
+}
+//Returns floor(base^(2n) / d) for d of n limbs whose top limb is at least base / 2.
+//Every level inverts the top half of d and refines it with one Newton step
+//x += x * (base^(2n) - d * x) / base^(2n), which doubles the number of correct limbs.
+BigFloatBase::LimbVector BigFloatBase::invert(const LimbVector &d) {
+    size_t n = d.size();
+    if(n <= 2) {
+        unsigned __int128 num = 1, den = 0;
+        for(size_t i = 0; i < 2 * n; ++i) num *= base;
+        for(size_t i = n; i-- > 0;) den = den * base + d[i];
+        unsigned __int128 q = num / den;
+        LimbVector res;
+        for(; q; q /= base) res.push_back(q % base);
+        return res;
     }
-    divideByTwo(integerPart, true);
-    divideByTwo(fractionalPart, false);
-    if(!divByTwo) {
-        fractionalPart[BigFloat::sizeOfFracPart - 1] += 5;
+    if constexpr (statsEnabled) count(Counter::NewtonStep);
+    size_t h = n / 2 + 1;
+    LimbVector x = invert(LimbVector(d.end() - h, d.end()));
+    x.insert(x.begin(), n - h, 0);
+
+    LimbVector power(2 * n + 1, 0);
+    power.back() = 1;
+    LimbVector dx = mulLimbs(d, x);
+    bool over = compare(dx, power) > 0;
+    LimbVector t = mulLimbs(x, substract(power, dx));
+    t.erase(t.begin(), t.begin() + std::min(t.size(), 2 * n));
+    x = over ? substract(x, t) : sum(x, t);
+    trim(x);
+
+    //Newton's step leaves x a few units away from the floor, walk the remainder back into [0, d)
+    const LimbVector one(1, 1);
+    dx = mulLimbs(d, x);
+    while(compare(dx, power) > 0) {
+        x = substract(x, one);
+        dx = substract(dx, d);
     }
-    if(fractionalPart[BigFloat::sizeOfFracPart - 1] >= base) {
-        addToIntPart(std::vector<int>(1, fractionalPart[BigFloat::sizeOfFracPart - 1] / base));
-        fractionalPart[BigFloat::sizeOfFracPart - 1] %= base;
+    LimbVector r = substract(power, dx);
+    while(compare(r, d) >= 0) {
+        x = sum(x, one);
+        r = substract(r, d);
     }
+    trim(x);
+    return x;
 }
-BigFloat& BigFloat::inverseSign() {
-    sign = 1 - sign;
-    return *this;
+//Returns floor(num / den) for trimmed integers, den must not be zero
+BigFloatBase::LimbVector BigFloatBase::divide(const LimbVector &num, const LimbVector &den) {
+    StatsScope scope(Counter::Division);
+    if(compare(num, den) < 0) {
+        return LimbVector(1, 0);
+    }
+    if(den.size() == 1) {
+        LimbVector q = num;
+        divideBySmall(q.data(), q.size(), den[0]);
+        trim(q);
+        return q;
+    }
+    //Scaling both operands keeps the quotient and makes the top limb of the divisor at least base / 2
+    uint32_t k = base / (den.back() + 1);
+    LimbVector a = mulBySmall(num, k);
+    LimbVector b = mulBySmall(den, k);
+    size_t n = b.size();
+    size_t shift = a.size() > 2 * n ? a.size() - 2 * n : 0;
+    LimbVector scaled = b;
+    scaled.insert(scaled.begin(), shift, 0);
+    //x = floor(base^(2n + shift) / b), so a * x is the quotient shifted by 2n + shift limbs, off by at most two
+    LimbVector q = mulLimbs(a, invert(scaled));
+    q.erase(q.begin(), q.begin() + std::min(q.size(), 2 * n + shift));
+    if(q.empty()) q.push_back(0);
+
+    const LimbVector one(1, 1);
+    LimbVector qb = mulLimbs(q, b);
+    while(compare(qb, a) > 0) {
+        q = substract(q, one);
+        qb = substract(qb, b);
+    }
+    LimbVector r = substract(a, qb);
+    while(compare(r, b) >= 0) {
+        q = sum(q, one);
+        r = substract(r, b);
+    }
+    trim(q);
+    return q;
 }
-BigFloat abs(const BigFloat &x) {
-    return BigFloat(x.integerPart, x.fractionalPart, 0);
+//x / y = floor(x * base^F / y) for both operands given as integers of fracLimbs fractional limbs
+BigFloatBase::LimbVector BigFloatBase::divideFixedPoint(LimbVector num, LimbVector den, int fracLimbs) {
+    num.insert(num.begin(), fracLimbs, 0);
+    //Low zero limbs of the divisor do not change the quotient, so small integer divisors turn into short division
+    size_t zeroes = 0;
+    for(; den[zeroes] == 0; ++zeroes);
+    //A divisor at least base^zeroes above the numerator leaves nothing
+    if(zeroes >= num.size()) {
+        return LimbVector(1, 0);
+    }
+    den.erase(den.begin(), den.begin() + zeroes);
+    num.erase(num.begin(), num.begin() + zeroes);
+    trim(num);
+    trim(den);
+    return divide(num, den);
 }
-BigFloat::BigFloat(const std::vector<int> &intPart, const std::vector<int> &fracPart, char sign_) : integerPart(intPart), fractionalPart(fracPart), sign(sign_){
-    normalise();
+BigFloatBase::LimbVector BigFloatBase::shifted(const LimbVector &x, ptrdiff_t limbs) {
+    LimbVector res;
+    if(limbs >= 0) {
+        res.assign(limbs, 0);
+        res.insert(res.end(), x.begin(), x.end());
+    } else if(static_cast<size_t>(-limbs) < x.size()) {
+        res.assign(x.begin() - limbs, x.end());
+    } else {
+        res.assign(1, 0);
+    }
+    return res;
 }
-BigFloat::BigFloat(int x) {
-    if(x < 0) {
-        sign = 1;
-        x = -x;
+//Returns about base^p / sqrt(a) for a = n / base^scale in [1, base^2), accurate to a few units of base^(p - 1).
+//Every level refines a root of half the precision with one Newton step y += y * (1 - a * y^2) / 2, which only
+//multiplies: about 3 multiplications of p limbs per level and 6 for the whole recursion
+BigFloatBase::LimbVector BigFloatBase::invSqrt(const LimbVector &n, size_t scale, size_t p) {
+    if(p <= 2) {
+        long double a = 0;
+        for(size_t i = n.size(); i-- > scale - 2;) a = a * base + n[i];
+        //a holds the top limbs of n as a * base^2, so y = base^p / sqrt(a) <= base^p fits 64 bits
+        auto y = static_cast<uint64_t>(std::pow(static_cast<long double>(base), static_cast<long double>(p + 1)) / std::sqrt(a));
+        LimbVector res{static_cast<uint32_t>(y % base), static_cast<uint32_t>(y / base % base), static_cast<uint32_t>(y / base / base)};
+        trim(res);
+        return res;
     }
-    else{
-        sign = 0;
+    //The relative error squares, so h limbs with h - 1 >= p / 2 suffice. The base case is good to ~base^-2 already
+    size_t h = p == 3 ? 2 : (p + 1) / 2 + 1;
+    LimbVector y = shifted(invSqrt(n, scale, h), p - h);
+    //y^2 is in (base^(2p - 2), base^(2p)], keeping p + 2 limbs of it leaves a * y^2 exact to a unit of base^-p
+    LimbVector y2 = shifted(mulLimbs(y, y), 2 - static_cast<ptrdiff_t>(p));
+    LimbVector ay2 = shifted(mulLimbs(shifted(n, static_cast<ptrdiff_t>(p) - static_cast<ptrdiff_t>(scale)), y2), -static_cast<ptrdiff_t>(p) - 2);
+    trim(ay2);
+    LimbVector one = shifted(LimbVector(1, 1), p);
+    bool over = compare(ay2, one) > 0;
+    LimbVector correction = mulLimbs(y, substract(one, ay2));
+    divideBySmall(correction.data(), correction.size(), 2);
+    correction = shifted(correction, -static_cast<ptrdiff_t>(p));
+    y = over ? substract(y, correction) : sum(y, correction);
+    trim(y);
+    return y;
+}
+//floor(sqrt(n)) for a trimmed n, through the inverse square root and one multiplication by n
+BigFloatBase::LimbVector BigFloatBase::isqrt(const LimbVector &n) {
+    StatsScope scope(Counter::Sqrt);
+    if(n.size() <= 4) {
+        unsigned __int128 v = 0;
+        for(size_t i = n.size(); i-- > 0;) v = v * base + n[i];
+        auto r = static_cast<uint64_t>(std::sqrt(static_cast<long double>(v)));
+        while(static_cast<unsigned __int128>(r) * r > v) --r;
+        while(static_cast<unsigned __int128>(r + 1) * (r + 1) <= v) ++r;
+        LimbVector res{static_cast<uint32_t>(r % base), static_cast<uint32_t>(r / base % base), static_cast<uint32_t>(r / base / base)};
+        trim(res);
+        return res;
     }
-    if(x == 0) {
-        integerPart.push_back(0);
+    //n = a * base^(2m) with a in [1, base^2), sqrt(n) = a * y * base^m for y = 1 / sqrt(a)
+    size_t m = (n.size() - 1) / 2;
+    size_t p = m + 2;
+    LimbVector y = invSqrt(n, 2 * m, p);
+    LimbVector r = shifted(mulLimbs(shifted(n, static_cast<ptrdiff_t>(p) - static_cast<ptrdiff_t>(2 * m)), y), -static_cast<ptrdiff_t>(2 * p - m));
+    trim(r);
+    //r is a few units away from the root, (r + 1)^2 = r^2 + 2r + 1 walks it without more multiplications
+    LimbVector square = mulLimbs(r, r);
+    const LimbVector one(1, 1);
+    while(compare(square, n) > 0) {
+        //(r - 1)^2 = r^2 - 2r + 1
+        square = sum(substract(square, sum(r, r)), one);
+        trim(square);
+        r = substract(r, one);
+        trim(r);
     }
-    while(x) {
-        integerPart.push_back(x % base);
-        x /= base;
+    while(true) {
+        LimbVector next = sum(square, sum(sum(r, r), one));
+        trim(next);
+        if(compare(next, n) > 0) break;
+        square = next;
+        r = sum(r, one);
     }
-    fractionalPart = std::vector<int> (BigFloat::sizeOfFracPart, 0);
-
+    trim(r);
+    return r;
+}
+//sqrt(x / base^F) * base^F = sqrt(x * base^F)
+BigFloatBase::LimbVector BigFloatBase::sqrtFixedPoint(const LimbVector &x, int fracLimbs) {
+    LimbVector n = shifted(x, fracLimbs);
+    trim(n);
+    return isqrt(n);
 }
-BigFloat::BigFloat(const char* x) {
-    char* s = const_cast<char *>(x);
+//Number of integer limbs parse() needs for x
+size_t BigFloatBase::parsedIntLimbs(const char *x) {
+    const char* s = x[0] == '-' ? x + 1 : x;
+    size_t intLen = strcspn(s, ".");
+    size_t firstDigit = 0;
+    while(firstDigit + 1 < intLen && s[firstDigit] == '0') ++firstDigit;
+    return std::max<size_t>(1, (intLen - firstDigit + digitsPerLimb - 1) / digitsPerLimb);
+}
+void BigFloatBase::parse(const char *x, char &sign, uint32_t *limbs, size_t intLimbs, int fracLimbs) {
+    const char* s = x;
     if(s[0] == '-') {
         sign = 1;
         ++s;
@@ -225,243 +1223,263 @@ BigFloat::BigFloat(const char* x) {
         sign = 0;
     }
     size_t n = strlen(s);
-    std::vector<int> digitsInt, digitsFrac;
-    digitsInt.reserve(n);
-    digitsFrac.reserve(n);
-    bool meetDot = false;
-    int digitsCnt = n - (strchr(x, '.') - x);
-    digitsFrac.reserve(digitsCnt);
-    for(int i = 0; i <= BigFloat::sizeOfFracPart - digitsCnt; ++i) digitsFrac.push_back(0);
-    for(int i = n - 1; i >= 0; --i) {
-        if(s[i] == '.') {
-            meetDot = true;
-            continue;
-        }
-        if(!meetDot) {
-            digitsFrac.push_back(s[i] - '0');
-        } else {
-            digitsInt.push_back(s[i] - '0');
-        }
-    }
-    integerPart = digitsInt;
-    fractionalPart = digitsFrac;
-}
-BigFloat operator+(const BigFloat &a, const BigFloat &b) {
-    if(a.sign == 0 && b.sign == 1) { //Полож +- отриц
-        BigFloat newB = b;
-        newB.inverseSign();
-        return a - newB;
-    }
-    if(a.sign == 1 && b.sign == 0) { //Отриц + полож
-        BigFloat newA = a;
-        newA.inverseSign();
-        BigFloat res = b - newA;
-        if(b > newA) {
-            res.sign = 0;
-            return res;
-        }
-        else{
-            res.sign = 1;
-            return res;
-        }
-    }
-    std::vector<int> resInt = BigFloat::sum(a.integerPart, b.integerPart);
-    std::vector<int> resFrac = BigFloat::sum(a.fractionalPart, b.fractionalPart);
-    if(resFrac.size() > BigFloat::sizeOfFracPart) {
-        resInt = BigFloat::sum(resInt, std::vector<int>(resFrac.begin() + BigFloat::sizeOfFracPart, resFrac.end()));
-        resFrac.resize(BigFloat::sizeOfFracPart);
-    }
-    return BigFloat(resInt, resFrac, a.sign);
-}
-BigFloat operator-(const BigFloat &a, const BigFloat &b) {
-    if(a.sign != b.sign) {
-        if(a.sign == 0) {
-            BigFloat newB = b;
-            newB.inverseSign();
-            return a + newB;
-        }
-        else if(b.sign == 0) {
-            BigFloat newA = a;
-            newA.inverseSign();
-            return (newA + b).inverseSign();
-        }
-    }
-    if(a.sign == 1 && b.sign == 1) {
-        BigFloat newB = b;
-        newB.inverseSign();
-        return newB + a;
-    }
-    std::vector<int> A = a.fractionalPart;
-    A.insert(A.end(), a.integerPart.begin(), a.integerPart.end());
-    std::vector<int> B = b.fractionalPart;
-    B.insert(B.end(), b.integerPart.begin(), b.integerPart.end());
-    std::vector<int> resVec;
-    if(a < b) {
-        std::swap(A, B);
-        resVec = BigFloat::substract(A, B);
-        int zeroesCnt = resVec.size() - 1;
-        for(; zeroesCnt >= 0 && resVec[zeroesCnt] == 0; --zeroesCnt);
-        return BigFloat(std::vector<int> (resVec.begin() + BigFloat::sizeOfFracPart, resVec.begin() + std::max(BigFloat::sizeOfFracPart + 1, zeroesCnt + 1)),
-                        std::vector<int> (resVec.begin(), resVec.begin() + BigFloat::sizeOfFracPart),
-                        1 - a.sign);
-    }
-    else {
-        resVec = BigFloat::substract(A, B);
-        int zeroesCnt = resVec.size() - 1;
-        for(; zeroesCnt >= 0 && resVec[zeroesCnt] == 0; --zeroesCnt);
-        return BigFloat(std::vector<int> (resVec.begin() + BigFloat::sizeOfFracPart, resVec.begin() + std::max(BigFloat::sizeOfFracPart + 1, zeroesCnt + 1)),
-                        std::vector<int> (resVec.begin(), resVec.begin() + BigFloat::sizeOfFracPart),
-                        a.sign);
-    }
-
-}
-bool BigFloat::operator >= (const BigFloat& other) const
-{
-    return !(*this < other);
-}
-bool BigFloat::operator <= (const BigFloat& other) const
-{
-    return *this < other || *this == other;
-}
-bool BigFloat::operator < (const BigFloat& other) const
-{
-    if(sign == 1 && other.sign == 0) {
-        return true;
-    }
-    if(sign == 0 && other.sign == 1) {
-        return false;
-    }
-    if(integerPart.size() < other.integerPart.size()) {
-        return 1 - sign;
+    const char* dot = strchr(s, '.');
+    size_t intLen = dot ? dot - s : n;
+    const char* frac = dot ? dot + 1 : s + n;
+    size_t fracLen = std::min<size_t>(s + n - frac, static_cast<size_t>(fracLimbs) * digitsPerLimb);
+    size_t firstDigit = 0;
+    while(firstDigit + 1 < intLen && s[firstDigit] == '0') ++firstDigit;
+    //Integer digits are grouped into limbs from the dot to the left
+    uint32_t *integerPart = limbs + fracLimbs;
+    std::fill(integerPart, integerPart + intLimbs, 0);
+    size_t limb = 0;
+    for(size_t end = intLen; end > firstDigit; ++limb) {
+        size_t begin = end > firstDigit + digitsPerLimb ? end - digitsPerLimb : firstDigit;
+        for(size_t i = begin; i < end; ++i) integerPart[limb] = integerPart[limb] * 10 + (s[i] - '0');
+        end = begin;
     }
-    if(integerPart.size() > other.integerPart.size()) {
-        return sign;
+    //Fractional digits are grouped from the dot to the right
+    for(size_t j = 0; j < static_cast<size_t>(fracLimbs); ++j) {
+        uint32_t value = 0;
+        for(size_t i = j * digitsPerLimb; i < (j + 1) * digitsPerLimb; ++i) {
+            value = value * 10 + (i < fracLen ? frac[i] - '0' : 0);
+        }
+        limbs[fracLimbs - 1 - j] = value;
     }
-    for(int i = integerPart.size() - 1; i >= 0; --i) {
-        if(integerPart[i] < other.integerPart[i]) {
-            return 1 - sign;
+}
+std::string BigFloatBase::format(char sign, const uint32_t *limbs, size_t size, int fracLimbs, size_t precision) {
+    std::string res;
+    res.reserve(2 + (size - fracLimbs) * digitsPerLimb + std::min(precision, static_cast<size_t>(fracLimbs) * digitsPerLimb));
+    writeDigits(sign, limbs, size, fracLimbs, precision, [&](const char *data, size_t n) { res.append(data, n); });
+    return res;
+}
+void BigFloatBase::write(std::ostream &out, char sign, const uint32_t *limbs, size_t size, int fracLimbs, size_t precision) {
+    writeDigits(sign, limbs, size, fracLimbs, precision, [&](const char *data, size_t n) { out.write(data, n); });
+}
+void BigFloatBase::write(int fd, char sign, const uint32_t *limbs, size_t size, int fracLimbs, size_t precision) {
+    writeDigits(sign, limbs, size, fracLimbs, precision, [&](const char *data, size_t n) {
+        while(n > 0) {
+            ssize_t written = ::write(fd, data, n);
+            if(written < 0) {
+                if(errno == EINTR) continue;
+                throw std::system_error(errno, std::generic_category(), "BigFloat: write failed");
+            }
+            data += written;
+            n -= written;
+        }
+    });
+}
+
+namespace {
+    //The binary form is little-endian, other hosts swap every word
+    constexpr bool littleEndianHost = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+    //"BFLT" read as a little-endian word
+    const uint32_t binaryMagic = 0x544C4642;
+
+    void writeWords(std::ostream &out, const uint32_t *words, size_t n) {
+        if (littleEndianHost) {
+            out.write(reinterpret_cast<const char *>(words), static_cast<std::streamsize>(n * sizeof(uint32_t)));
+            return;
         }
-        if(integerPart[i] > other.integerPart[i]) {
-            return sign;
+        uint32_t buffer[1024];
+        for (size_t i = 0; i < n; i += 1024) {
+            size_t m = std::min<size_t>(1024, n - i);
+            for (size_t j = 0; j < m; ++j) buffer[j] = __builtin_bswap32(words[i + j]);
+            out.write(reinterpret_cast<const char *>(buffer), static_cast<std::streamsize>(m * sizeof(uint32_t)));
         }
     }
-    for(int i = BigFloat::sizeOfFracPart - 1; i >= 0; --i) {
-        if(fractionalPart[i] < other.fractionalPart[i]) {
-            return 1 - sign;
+    bool readWords(std::istream &in, uint32_t *words, size_t n) {
+        if (!in.read(reinterpret_cast<char *>(words), static_cast<std::streamsize>(n * sizeof(uint32_t)))) {
+            return false;
         }
-        if(fractionalPart[i] > other.fractionalPart[i]) {
-            return sign;
+        if (!littleEndianHost) {
+            for (size_t i = 0; i < n; ++i) words[i] = __builtin_bswap32(words[i]);
         }
+        return true;
     }
-    return false;
 }
-bool BigFloat::operator == (const BigFloat& other) const
-{
-    for(int i = 0; i < BigFloat::sizeOfFracPart; ++i) {
-        if(fractionalPart[i] != other.fractionalPart[i]) {
-            return false;
-        }
+
+void BigFloatBase::writeBinary(std::ostream &out, char sign, const uint32_t *limbs, size_t size, int fracLimbs) {
+    uint64_t n = size;
+    const uint32_t header[6] = {binaryMagic, binaryVersion, static_cast<uint32_t>(sign), static_cast<uint32_t>(fracLimbs),
+                                static_cast<uint32_t>(n), static_cast<uint32_t>(n >> 32)};
+    writeWords(out, header, 6);
+    writeWords(out, limbs, size);
+}
+BigFloatBase::LimbVector BigFloatBase::readBinary(std::istream &in, char &sign, int fracLimbs) {
+    uint32_t header[6];
+    if (!readWords(in, header, 6) || header[0] != binaryMagic) {
+        throw std::runtime_error("BigFloat: not a binary value");
     }
-    if(integerPart.back() == 0  && integerPart.size() > 1 || other.integerPart.back() == 0 && other.integerPart.size() > 1) {
-        std::cerr << "ERROR! - Leading zeroes";
-        std::cerr << this->toString(BigFloat::sizeOfFracPart) << ' ' << other.toString(BigFloat::sizeOfFracPart) << '\n';
+    if (header[1] != binaryVersion) {
+        throw std::runtime_error("BigFloat: unsupported binary version " + std::to_string(header[1]));
     }
-    if(integerPart.size() != other.integerPart.size())
-        return false;
-    for(int i = 0; i < integerPart.size(); ++i) {
-        if(integerPart[i] != other.integerPart[i]) {
-            return false;
+    uint64_t size = header[4] | static_cast<uint64_t>(header[5]) << 32;
+    uint32_t storedFracLimbs = header[3];
+    if (header[2] > 1 || size <= storedFracLimbs) {
+        throw std::runtime_error("BigFloat: malformed binary value");
+    }
+    //Storage grows with the limbs actually read, a corrupt count does not turn into a huge allocation
+    LimbVector limbs;
+    for (uint64_t done = 0; done < size;) {
+        size_t chunk = static_cast<size_t>(std::min<uint64_t>(size - done, 1 << 16));
+        limbs.resize(done + chunk);
+        if (!readWords(in, limbs.data() + done, chunk)) {
+            throw std::runtime_error("BigFloat: truncated binary value");
         }
+        done += chunk;
+    }
+    if (std::any_of(limbs.begin(), limbs.end(), [](uint32_t limb) { return limb >= base; })) {
+        throw std::runtime_error("BigFloat: malformed binary value");
+    }
+    sign = static_cast<char>(header[2]);
+    if (storedFracLimbs > static_cast<uint32_t>(fracLimbs)) {
+        limbs.erase(limbs.begin(), limbs.begin() + (storedFracLimbs - fracLimbs));
+    } else {
+        limbs.insert(limbs.begin(), fracLimbs - storedFracLimbs, 0);
     }
-    return sign == other.sign || integerPart == std::vector{0} && other.integerPart == std::vector{0};
+    return limbs;
 }
 
-bool BigFloat::operator!=(const BigFloat &other) const {
-    return !(*this == other);
-}
-bool BigFloat::operator>(const BigFloat &other) const {
-    return !(*this <= other);
-}
-BigFloat& BigFloat::operator -() {
-    sign = 1 - sign;
-    return *this;
-}
-BigFloat operator*(const BigFloat &a, const BigFloat &b) {
-    std::vector<int> A = a.fractionalPart;
-    A.insert(A.end(), a.integerPart.begin(), a.integerPart.end());
-    std::vector<int> B = b.fractionalPart;
-    B.insert(B.end(), b.integerPart.begin(), b.integerPart.end());
-    if(std::accumulate(A.begin(), A.end(), 0) == 0 || std::accumulate(B.begin(), B.end(), 0) == 0) {
-        return BigFloat("0.");
+uint64_t BigFloatBase::scaledFloor(const uint32_t *x, size_t n, ptrdiff_t limbShift, int bitShift, bool &inexact) {
+    inexact = false;
+    size_t zeroes = limbShift > 0 ? limbShift : 0;
+    Scratch scratch;
+    uint32_t *v = scratch.alloc(zeroes + n + std::max(bitShift, 0) / 29 + 1);
+    std::fill(v, v + zeroes, 0);
+    std::copy(x, x + n, v + zeroes);
+    size_t size = zeroes + n;
+    //Powers of two up to 2^29 stay below base, so every step is a short multiplication or division
+    for (int left = bitShift; left > 0; left -= 29) {
+        uint32_t carry = mulBySmall(v, v, size, uint32_t(1) << std::min(left, 29));
+        if (carry) {
+            v[size++] = carry;
+        }
+    }
+    for (int left = -bitShift; left > 0; left -= 29) {
+        inexact |= divideBySmall(v, size, uint32_t(1) << std::min(left, 29)) != 0;
+    }
+    size_t drop = limbShift < 0 ? std::min<size_t>(-limbShift, size) : 0;
+    inexact |= std::any_of(v, v + drop, [](uint32_t limb) { return limb != 0; });
+    uint64_t res = 0;
+    for (size_t i = size; i-- > drop;) {
+        res = res * base + v[i];
     }
-    std::vector<int> resVec = BigFloat::mult(A, B);
-    int firstNonZero = resVec.size() - 1;
-    for(; firstNonZero >= 0 && resVec[firstNonZero] == 0; --firstNonZero);
-    BigFloat res(std::vector<int>(resVec.begin() + 2 * BigFloat::sizeOfFracPart, resVec.begin() + std::max(2 * BigFloat::sizeOfFracPart + 1, firstNonZero + 1)),
-                 std::vector<int>(resVec.begin() + BigFloat::sizeOfFracPart, resVec.begin() + 2 * BigFloat::sizeOfFracPart),
-                 a.sign ^ b.sign);
     return res;
 }
-BigFloat operator/(const BigFloat &x, const BigFloat &y) {
-    if(std::accumulate(y.fractionalPart.begin(), y.fractionalPart.end(), 0) == 0 && std::accumulate(y.integerPart.begin(), y.integerPart.end(), 0) == 0) {
-        std::cerr << "ERROR! - Division by zero";
-        throw std::runtime_error("Division by zero");
-    }
-    if(std::accumulate(x.fractionalPart.begin(), x.fractionalPart.end(), 0) == 0 && std::accumulate(x.integerPart.begin(), x.integerPart.end(), 0) == 0) {
-        return BigFloat("0.");
-    }
-    BigFloat a = x;
-    BigFloat b = y;
-    if(a.sign == 1) {
-        a.inverseSign();
-    }
-    if(b.sign == 1) {
-        b.inverseSign();
-    }
-    BigFloat L("0.");
-    BigFloat R = a;
-    BigFloat eps(std::vector<int>(1, 0), std::vector<int> (BigFloat::sizeOfFracPart, 0), 0);
-    static_assert(BigFloat::sizeOfFracPart >= 11, "BigFloat::sizeOfFracPart must be at least 11"); //103 is a magic precision for 100-digit precise PI calculation
-    //Precision (number a bit bigger than 1, e.x. 20)
-    eps.fractionalPart[2] = 1;
-    while (R - L >= eps) {
-        BigFloat M = (L + R);
-        M.divideByTwo();
-        if (M * b < a) {
-            L = M;
+//q = floor(|x| 2^t) is taken with 55 to 58 bits and cut down to 54, the last of them being the rounding bit.
+//The top four limbs settle q unless |x| lies next to a multiple of 2^-t, only then all the limbs are read
+double BigFloatBase::toDouble(char sign, const uint32_t *limbs, size_t size, int fracLimbs) {
+    auto top = static_cast<ptrdiff_t>(size) - 1;
+    while (top >= 0 && limbs[top] == 0) {
+        --top;
+    }
+    if (top < 0) {
+        return 0.0;
+    }
+    ptrdiff_t first = std::max<ptrdiff_t>(0, top - 2);
+    double head = 0;
+    for (ptrdiff_t i = top; i >= first; --i) {
+        head = head * base + limbs[i];
+    }
+    double log2x = std::log2(head) + static_cast<double>(first - fracLimbs) * digitsPerLimb * 3.321928094887362;
+    if (log2x >= 1025) {
+        return sign ? -HUGE_VAL : HUGE_VAL;
+    }
+    if (log2x < -1077) {
+        return sign ? -0.0 : 0.0;
+    }
+    int t = 56 - static_cast<int>(std::floor(log2x));
+    ptrdiff_t low = std::max<ptrdiff_t>(0, top - 3);
+    bool inexact;
+    uint64_t q = scaledFloor(limbs + low, top + 1 - low, low - fracLimbs, t, inexact);
+    if (std::any_of(limbs, limbs + low, [](uint32_t limb) { return limb != 0; })) {
+        //|x| lies strictly between the window and the window plus a unit of its last limb
+        uint32_t next[5] = {};
+        const uint32_t one = 1;
+        size_t n = top + 1 - low;
+        std::copy(limbs + low, limbs + top + 1, next);
+        n += sum(next, next, n, &one, 1);
+        bool whole;
+        if (scaledFloor(next, n, low - fracLimbs, t, whole) == q) {
+            inexact = true;
         } else {
-            R = M;
+            q = scaledFloor(limbs, top + 1, -fracLimbs, t, inexact);
         }
     }
-    R.sign = x.sign ^ y.sign;
-    return R;
+    //Bits below the rounding bit only tell whether it is a tie; subnormals keep 2^-1074 as their last bit
+    while (q >= uint64_t(1) << 54 || t > 1075) {
+        inexact |= q & 1;
+        q >>= 1;
+        --t;
+    }
+    uint64_t mantissa = q >> 1;
+    if ((q & 1) && (inexact || (mantissa & 1))) {
+        ++mantissa;
+    }
+    double res = std::ldexp(static_cast<double>(mantissa), 1 - t);
+    return sign ? -res : res;
 }
-
-std::string BigFloat::toString(size_t precision) const {
-    std::string res;
-    if(this->sign) {
-        res += '-';
+size_t BigFloatBase::fromDouble(double x, char &sign, uint32_t *res, int fracLimbs) {
+    if (!std::isfinite(x)) {
+        throw std::domain_error("BigFloat: not a finite double");
     }
-    for(int i = this->integerPart.size() - 1; i >= 0; --i) {
-        res += static_cast<char>('0' + this->integerPart[i]);
+    sign = x < 0;
+    //|x| = m 2^e with a 53-bit integer m
+    int e;
+    auto m = static_cast<uint64_t>(std::ldexp(std::frexp(std::fabs(x), &e), 53));
+    e -= 53;
+    std::fill(res, res + fracLimbs, 0);
+    size_t size = fracLimbs;
+    do {
+        res[size++] = m % base;
+        m /= base;
+    } while (m);
+    for (int left = e; left > 0; left -= 29) {
+        uint32_t carry = mulBySmall(res, res, size, uint32_t(1) << std::min(left, 29));
+        if (carry) {
+            res[size++] = carry;
+        }
     }
-    res += '.';
-    for(int i = this->fractionalPart.size() - 1; i >= 0 && i >= this->fractionalPart.size() - std::min(precision, this->fractionalPart.size()); --i) {
-        res += static_cast<char>('0' + this->fractionalPart[i]);
+    //The bits that land past the last fractional limb are dropped
+    for (int left = -e; left > 0; left -= 29) {
+        divideBySmall(res, size, uint32_t(1) << std::min(left, 29));
     }
-    return res;
+    return size;
 }
-void display(const BigFloat &x, size_t precision) {
-    std::cout << x.toString(precision) << '\n';
-}
-std::ostream& operator<<(std::ostream &out, BigFloat &x) {
-    out << x.toString(BigFloat::sizeOfFracPart);
-    return out;
+double BigFloatBase::estimate(char sign, const uint32_t *limbs, size_t size, int fracLimbs) {
+    auto top = static_cast<ptrdiff_t>(size) - 1;
+    while (top >= 0 && limbs[top] == 0) {
+        --top;
+    }
+    if (top < 0) {
+        return 0.0;
+    }
+    ptrdiff_t first = std::max<ptrdiff_t>(0, top - 2);
+    double head = 0;
+    for (ptrdiff_t i = top; i >= first; --i) {
+        head = head * base + limbs[i];
+    }
+    //Powers of base within the double range come from a table, two factors cover the rest
+    static const auto powers = [] {
+        std::array<double, 35> p{1};
+        for (size_t i = 1; i < p.size(); ++i) p[i] = p[i - 1] * base;
+        return p;
+    }();
+    ptrdiff_t e = first - fracLimbs;
+    double res;
+    if (e >= 0 && e < static_cast<ptrdiff_t>(powers.size())) {
+        res = head * powers[e];
+    } else if (e < 0 && -e < static_cast<ptrdiff_t>(powers.size())) {
+        res = head / powers[-e];
+    } else {
+        auto d = static_cast<double>(e * digitsPerLimb);
+        res = head * std::pow(10.0, std::trunc(d / 2)) * std::pow(10.0, d - std::trunc(d / 2));
+    }
+    return sign ? -res : res;
 }
 
-BigFloat::operator double() const {
-    return std::stod(toString(10));
-}
+template class BasicBigFloat<128>;
 
 BigFloat operator""_bf(const char *s) {
     return BigFloat{s};
@@ -1,48 +1,1365 @@
 #pragma once
 #include <vector>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <climits>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include <numeric>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#if defined(__cpp_impl_three_way_comparison) && __cpp_impl_three_way_comparison >= 201907L && __has_include(<compare>)
+#include <compare>
+#endif
 
-class BigFloat {
+//Limb arithmetic shared by every precision.
+//Numbers are little-endian arrays of limbs, every limb keeps digitsPerLimb decimal digits
+class BigFloatBase {
+public:
+    //Operand sizes in limbs where multiplication switches algorithm: naive_mul up to `karatsuba` limbs,
+    //karatsuba_mul below `toom3` limbs, toom3_mul below `ntt` limbs and the number-theoretic transform from there on.
+    //The Karatsuba cutoff is raised to at least 3 limbs
+    struct MulThresholds {
+        size_t karatsuba;
+        size_t toom3;
+        size_t ntt;
+    };
+    static MulThresholds mulThresholds();
+    static void setMulThresholds(MulThresholds thresholds);
+    //Times the tiers against each other on this host and returns the sizes where each one starts to win.
+    //Nothing is applied, pass the result to setMulThresholds. Takes a fraction of a second on the calling thread only
+    static MulThresholds tuneMulThresholds();
+    //Worker threads a single operation may be split across, 0 keeps all work on the calling thread.
+    //Defaults to one less than the hardware concurrency. Must not be changed while operations are in flight
+    static unsigned workerCount();
+    static void setWorkerCount(unsigned workers);
+    //Operand size in limbs below which multiplication work is not split across workers
+    static size_t parallelCutoff();
+    static void setParallelCutoff(size_t limbs);
+    //Heap allocations made on the calling thread for BigFloat storage and scratch memory
+    static uint64_t allocationCount();
+    //Instruction sets of the limb kernels, the best one the CPU supports is picked at startup
+    enum class Simd { Scalar, AVX2, AVX512 };
+    static Simd simd();
+    //Levels the CPU lacks fall back to the best supported one
+    static void setSimd(Simd level);
+    //Constants held by the process-wide cache of Constants.h
+    enum class Constant { Pi, E, Ln2, Sqrt2 };
+
+    //Statistics are only gathered when the library is built with BIGFLOAT_STATS, otherwise their hooks compile away
+#ifdef BIGFLOAT_STATS
+    static constexpr bool statsEnabled = true;
+#else
+    static constexpr bool statsEnabled = false;
+#endif
+    //Operation counts and cumulative times summed over all threads, all zero without BIGFLOAT_STATS.
+    //A tier is timed over its outermost calls on each thread, so its time includes the tiers it runs
+    struct Stats {
+        struct Tier {
+            uint64_t calls = 0;
+            uint64_t ns = 0;
+        };
+        //naiveMul counts leaf products only, karatsubaMul and toom3Mul every level of the recursion
+        Tier naiveMul, karatsubaMul, toom3Mul, nttMul, division, sqrt;
+        //Newton levels of the reciprocals behind long division
+        uint64_t newtonSteps = 0;
+        //Resolutions of deferred carries, in naive_mul columns and in accumulators
+        uint64_t carryPasses = 0;
+        //Heap allocations, as counted by allocationCount
+        uint64_t allocations = 0;
+    };
+    static Stats stats();
+    //Zeroes the statistics of every thread. Operations running meanwhile may keep part of their counts
+    static void resetStats();
+    //Receives the diagnostic messages of the library, such as a division by zero. Messages are dropped while no sink is set, an empty function drops them again
+    static void setDiagnosticSink(std::function<void(const std::string &)> sink);
+
+protected:
+    static constexpr uint32_t base = 1000000000;
+    static constexpr int digitsPerLimb = 9;
+    //Fractions up to this many limbs live inline and are multiplied by the fixed-size kernels
+    static constexpr int maxInlineFracLimbs = 64;
+    static constexpr size_t naiveLimit = 32;
+
+    static void countAllocation();
+    static void diagnostic(const std::string &message);
+
+    enum class Counter { NaiveMul, KaratsubaMul, Toom3Mul, NttMul, Division, Sqrt, NewtonStep, CarryPass, Allocation, Count };
+    //Only called when statsEnabled
+    static void count(Counter c);
+    //Counts a call of a tier and times it if it is the outermost one on this thread. Empty without BIGFLOAT_STATS
+    class StatsScope {
+    public:
+        explicit StatsScope(Counter c) : counter(c) {
+            if constexpr (statsEnabled) start = enter(c);
+        }
+        ~StatsScope() {
+            if constexpr (statsEnabled) leave(counter, start);
+        }
+        StatsScope(const StatsScope &) = delete;
+        StatsScope &operator=(const StatsScope &) = delete;
+    private:
+        //Returns the start time of an outermost call and UINT64_MAX for a nested one
+        static uint64_t enter(Counter c);
+        static void leave(Counter c, uint64_t start);
+        Counter counter;
+        uint64_t start = 0;
+    };
+
+    //Per-thread bump allocator for kernel temporaries. Memory taken inside a frame is released when the
+    //frame ends and stays reserved for the next call, so steady-state arithmetic does not touch the heap
+    class Scratch {
+    public:
+        Scratch();
+        ~Scratch();
+        Scratch(const Scratch &) = delete;
+        Scratch &operator=(const Scratch &) = delete;
+        uint32_t *alloc(size_t n);
+    private:
+        size_t chunk, offset;
+    };
+
+    //Vector of limbs that keeps up to InlineCap limbs inside the object
+    template<size_t InlineCap>
+    class LimbStorage;
+
+    template<class T>
+    struct CountingAllocator {
+        using value_type = T;
+        CountingAllocator() = default;
+        template<class U> CountingAllocator(const CountingAllocator<U> &) {}
+        T *allocate(size_t n) {
+            countAllocation();
+            return std::allocator<T>().allocate(n);
+        }
+        void deallocate(T *p, size_t n) {
+            std::allocator<T>().deallocate(p, n);
+        }
+        friend bool operator==(const CountingAllocator &, const CountingAllocator &) { return true; }
+        friend bool operator!=(const CountingAllocator &, const CountingAllocator &) { return false; }
+    };
+    using LimbVector = std::vector<uint32_t, CountingAllocator<uint32_t>>;
+
+    //Kernels work on raw limb ranges, results never alias operands unless stated otherwise
+    static void naive_mul(uint32_t *res, const uint32_t *x, size_t xn, const uint32_t *y, size_t yn);
+    static void karatsuba_mul(uint32_t *res, const uint32_t *x, const uint32_t *y, size_t len);
+    static void toom3_mul(uint32_t *res, const uint32_t *x, const uint32_t *y, size_t len);
+    //res = x^2, 2n limbs, forming every cross product once
+    static void naive_sqr(uint32_t *res, const uint32_t *x, size_t n);
+    //Product of two len-limb operands by the tier len falls in. Squares are recognised by x == y, here and in mult
+    static void balanced_mul(uint32_t *res, const uint32_t *x, const uint32_t *y, size_t len);
+    template<size_t N> static void naive_mul_fixed(const uint32_t *x, const uint32_t *y, uint32_t *res);
+    template<size_t N> static void karatsuba_mul_fixed(const uint32_t *x, const uint32_t *y, uint32_t *res);
+    static void ntt_mul(uint32_t *res, const uint32_t *x, size_t xn, const uint32_t *y, size_t yn);
+    //res = x * y, xn + yn limbs
+    static void mult(uint32_t *res, const uint32_t *x, size_t xn, const uint32_t *y, size_t yn);
+    //res = x + y, max(xn, yn) limbs, returns the carry. res may be x or y
+    static uint32_t sum(uint32_t *res, const uint32_t *x, size_t xn, const uint32_t *y, size_t yn);
+    //res = x - y for xn >= yn, xn limbs, returns the loan. res may be x
+    static uint32_t substract(uint32_t *res, const uint32_t *x, size_t xn, const uint32_t *y, size_t yn);
+    static int compare(const uint32_t *x, size_t xn, const uint32_t *y, size_t yn);
+    //res = x * y for y < base, n limbs, returns the carry
+    static uint32_t mulBySmall(uint32_t *res, const uint32_t *x, size_t n, uint32_t y);
+    //x /= y in place, returns the remainder
+    static uint32_t divideBySmall(uint32_t *x, size_t n, uint32_t y);
+    //res = x * y, n limbs, returns the carry (at most y). res may be x
+    static uint64_t mulByWord(uint32_t *res, const uint32_t *x, size_t n, uint64_t y);
+    //x /= y in place, returns the remainder
+    static uint64_t divideByWord(uint32_t *x, size_t n, uint64_t y);
+
+    //Helpers on whole vectors for the division code
+    static void trim(LimbVector &digits);
+    static LimbVector sum(const LimbVector &x, const LimbVector &y);
+    static LimbVector substract(const LimbVector &x, const LimbVector &y);
+    static int compare(const LimbVector &x, const LimbVector &y);
+    static LimbVector mulLimbs(const LimbVector &x, const LimbVector &y);
+    static LimbVector mulBySmall(const LimbVector &x, uint32_t y);
+    static LimbVector invert(const LimbVector &d);
+    static LimbVector divide(const LimbVector &num, const LimbVector &den);
+    static LimbVector divideFixedPoint(LimbVector num, LimbVector den, int fracLimbs);
+    //x * base^limbs, negative shifts drop low limbs
+    static LimbVector shifted(const LimbVector &x, ptrdiff_t limbs);
+    static LimbVector invSqrt(const LimbVector &n, size_t scale, size_t p);
+    //floor(sqrt(n)), about 8 multiplications of n.size() / 2 limbs
+    static LimbVector isqrt(const LimbVector &n);
+    //Root of a fixed-point number with fracLimbs fractional limbs, in the same format
+    static LimbVector sqrtFixedPoint(const LimbVector &x, int fracLimbs);
+    //floor(c * base^fracLimbs) from the constants cache, defined next to it
+    static LimbVector constantFixedPoint(Constant c, int fracLimbs);
+    //Argument halvings that balance their price against the series terms they save, sqrt(digits * log2(10) / cost)
+    //where one halving costs as much as cost terms
+    static constexpr int halvings(int digits, int cost) {
+        int s = 1;
+        while (s * s * cost * 10 < digits * 33) ++s;
+        return s;
+    }
+
+    static size_t parsedIntLimbs(const char *x);
+    static void parse(const char *x, char &sign, uint32_t *limbs, size_t intLimbs, int fracLimbs);
+    static std::string format(char sign, const uint32_t *limbs, size_t size, int fracLimbs, size_t precision);
+    //Same text as format, written in fixed-size chunks. The descriptor version throws std::system_error on failure
+    static void write(std::ostream &out, char sign, const uint32_t *limbs, size_t size, int fracLimbs, size_t precision);
+    static void write(int fd, char sign, const uint32_t *limbs, size_t size, int fracLimbs, size_t precision);
+    //Binary form of a value, 32-bit little-endian words: "BFLT", binaryVersion, sign, fracLimbs, the limb count
+    //as two words (low first) and the limbs
+    static constexpr uint32_t binaryVersion = 1;
+    static void writeBinary(std::ostream &out, char sign, const uint32_t *limbs, size_t size, int fracLimbs);
+    //Reads a value written by writeBinary with its fraction cut or padded to fracLimbs limbs.
+    //Throws std::runtime_error when the input is truncated or is not such a value
+    static LimbVector readBinary(std::istream &in, char &sign, int fracLimbs);
+    //Conversions between limbs and hardware numbers, none of them goes through text.
+    //toDouble rounds to nearest with ties to even. fromDouble truncates to fracLimbs fractional limbs, writes
+    //at most fracLimbs + doubleIntLimbs limbs to res and returns their count; infinities and NaN throw std::domain_error
+    static constexpr size_t doubleIntLimbs = 35;
+    static double toDouble(char sign, const uint32_t *limbs, size_t size, int fracLimbs);
+    static size_t fromDouble(double x, char &sign, uint32_t *res, int fracLimbs);
+    //The top three limbs times a power of ten, within a few units of the last bit of the exact value
+    static double estimate(char sign, const uint32_t *limbs, size_t size, int fracLimbs);
+    //floor(x * base^limbShift * 2^bitShift) for the integer x of n limbs, which must stay below 2^64.
+    //inexact is set when the scaled value is not whole
+    static uint64_t scaledFloor(const uint32_t *x, size_t n, ptrdiff_t limbShift, int bitShift, bool &inexact);
+
+private:
+    template<size_t... J>
+    static uint64_t mulRow(uint32_t xi, const uint32_t *y, uint32_t *res, std::index_sequence<J...>);
+};
+
+template<size_t InlineCap>
+class BigFloatBase::LimbStorage {
+public:
+    //ptr is set in the body: -Wuninitialized reads buf.data() in the initializer list as a use of buf
+    LimbStorage() : len(0), cap(InlineCap) { ptr = buf.data(); }
+    LimbStorage(const LimbStorage &other) : LimbStorage() {
+        if (!copyInline(other)) {
+            assign(other.begin(), other.end());
+        }
+    }
+    LimbStorage(LimbStorage &&other) noexcept : LimbStorage() {
+        *this = std::move(other);
+    }
+    LimbStorage &operator=(const LimbStorage &other) {
+        if (this != &other && (onHeap() || !copyInline(other))) {
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+    LimbStorage &operator=(LimbStorage &&other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+        if (other.onHeap()) {
+            release();
+            ptr = other.ptr;
+            cap = other.cap;
+            len = other.len;
+            other.ptr = other.buf.data();
+            other.cap = InlineCap;
+            other.len = 0;
+        } else {
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+    ~LimbStorage() {
+        release();
+    }
+
+    [[nodiscard]] size_t size() const { return len; }
+    uint32_t *data() { return ptr; }
+    [[nodiscard]] const uint32_t *data() const { return ptr; }
+    uint32_t *begin() { return ptr; }
+    uint32_t *end() { return ptr + len; }
+    [[nodiscard]] const uint32_t *begin() const { return ptr; }
+    [[nodiscard]] const uint32_t *end() const { return ptr + len; }
+    uint32_t &operator[](size_t i) { return ptr[i]; }
+    const uint32_t &operator[](size_t i) const { return ptr[i]; }
+    [[nodiscard]] uint32_t back() const { return ptr[len - 1]; }
+
+    //New limbs are zero
+    void resize(size_t n) {
+        reserve(n);
+        if (n > len) {
+            std::fill(ptr + len, ptr + n, 0);
+        }
+        len = n;
+    }
+    void reserve(size_t n) {
+        if (n <= cap) {
+            return;
+        }
+        size_t newCap = std::max(n, 2 * cap);
+        auto *p = new uint32_t[newCap];
+        countAllocation();
+        if (len) {
+            std::copy(ptr, ptr + len, p);
+        }
+        release();
+        ptr = p;
+        cap = newCap;
+    }
+    void push_back(uint32_t limb) {
+        if (len == cap) {
+            reserve(len + 1);
+        }
+        ptr[len++] = limb;
+    }
+    void pop_back() {
+        --len;
+    }
+    void assign(const uint32_t *first, const uint32_t *last) {
+        size_t n = last - first;
+        //Empty storage without inline limbs has null pointers, which std::copy must not see
+        if (n == 0) {
+            len = 0;
+            return;
+        }
+        if (n > cap) {
+            len = 0;
+            reserve(n);
+        }
+        std::copy(first, last, ptr);
+        len = n;
+    }
+
+private:
+    //Heap blocks are always larger than the inline buffer, which may have no address of its own when InlineCap is 0
+    [[nodiscard]] bool onHeap() const { return cap > InlineCap; }
+    //Inline limbs of another storage are copied as one fixed-size block, which compiles to a few vector moves
+    bool copyInline(const LimbStorage &other) {
+        if constexpr (InlineCap > 0) {
+            if (!other.onHeap()) {
+                std::memcpy(buf.data(), other.buf.data(), sizeof(buf));
+                len = other.len;
+                return true;
+            }
+        }
+        return false;
+    }
+    void release() {
+        if (onHeap()) {
+            delete[] ptr;
+        }
+    }
+    std::array<uint32_t, InlineCap> buf;
+    uint32_t *ptr;
+    size_t len, cap;
+};
+
+//Read-only value whose limbs are owned elsewhere, by a BasicBigFloat or a mapped BigFloatTable,
+//and stay valid only as long as their owner does
+class BigFloatView : public BigFloatBase {
+public:
+    BigFloatView(char sign, const uint32_t *limbs, size_t size, int fracLimbs)
+        : negative(sign), first(limbs), length(size), fraction(fracLimbs) {}
+    [[nodiscard]] char sign() const { return negative; }
+    //fracLimbs fractional limbs followed by the integer part, like BasicBigFloat
+    [[nodiscard]] const uint32_t *limbs() const { return first; }
+    [[nodiscard]] size_t size() const { return length; }
+    [[nodiscard]] int fracLimbs() const { return fraction; }
+    [[nodiscard]] std::string toString(size_t precision) const { return format(negative, first, length, fraction, precision); }
+    [[nodiscard]] double toDouble() const { return BigFloatBase::toDouble(negative, first, length, fraction); }
+    void write(std::ostream &out, size_t precision) const { BigFloatBase::write(out, negative, first, length, fraction, precision); }
+    void serialize(std::ostream &out) const { writeBinary(out, negative, first, length, fraction); }
+
+private:
+    char negative;
+    const uint32_t *first;
+    size_t length;
+    int fraction;
+};
+
+template<int FracDigits>
+class BasicBigFloatAccumulator;
+template<int FracDigits>
+class BasicBigFloatArray;
+
+//Fixed point number with FracDigits decimal digits after the dot (rounded up to whole limbs)
+template<int FracDigits>
+class BasicBigFloat : public BigFloatBase {
+    template<int> friend class BasicBigFloat;
+    friend class BasicBigFloatAccumulator<FracDigits>;
 private:
-    std::vector<int> integerPart, fractionalPart;
+    static constexpr int fracLimbs = (FracDigits + digitsPerLimb - 1) / digitsPerLimb;
+    static constexpr int sizeOfFracPart = fracLimbs * digitsPerLimb;
+    static constexpr bool inlineFraction = fracLimbs <= maxInlineFracLimbs;
+
+    //fracLimbs fractional limbs followed by the integer part (at least one limb, no leading zeroes).
+    //Small precisions keep the fraction and two integer limbs inside the object
+    LimbStorage<inlineFraction ? fracLimbs + 2 : 0> limbs;
     char sign;
-    //Must be a power of 2
-    static const int sizeOfFracPart = 128;
-    static const int base = 10;
-    void addToIntPart(const std::vector<int> &digits);
-    static void extend_vec(std::vector<int>& v, size_t len);
-    static std::vector<int> naive_mul(const std::vector<int>& x, const std::vector<int>& y);
-    static std::vector<int> karatsuba_mul(const std::vector<int>& x, const std::vector<int>& y);
-    static void finalize(std::vector<int>& res);
-    static std::vector<int> mult(std::vector<int>& x, std::vector<int>& y);
-    static std::vector<int> sum(const std::vector<int> &x, const std::vector<int> &y);
-    static std::vector<int> substract(const std::vector<int> &x, const std::vector<int> &y);
-    void addToFracPart(const std::vector<int> &digits);
-    void normalise();
-    static void divideByTwo(std::vector<int> &digits, bool removeZeroes);
-    void divideByTwo();
+    //Set only when every fractional limb is known to be zero, operands with it skip their fraction
+    bool integral;
+    //Index of the top nonzero limb, -1 for zero. Every operation leaves its result canonical: trimmed, with top
+    //up to date and the sign of zero cleared, so zero tests and most comparisons never read the limbs
+    ptrdiff_t top;
+
+    BasicBigFloat() : sign(0), integral(false), top(-1) {}
+    [[nodiscard]] bool fractionIsZero() const;
+    [[nodiscard]] size_t intSize() const { return limbs.size() - fracLimbs; }
+    [[nodiscard]] bool isZero() const { return top < 0; }
+    [[nodiscard]] ptrdiff_t topLimb() const { return top; }
+    void trim();
+    //Trims, finds the top limb and clears the sign of zero. Values of at least 1 take a single step
+    void canonicalise();
+    void setZero();
+    static int compareMagnitudes(const BasicBigFloat &a, const BasicBigFloat &b);
+    //Sets res from limbs where limbs[offset] is the lowest fractional limb, limbs must not point into res
+    static void assign(BasicBigFloat &res, const uint32_t *limbs, size_t size, size_t offset, char sign_);
+    //Operations store into res, which may be one of the operands; its storage is reused
+    static void addMagnitudes(BasicBigFloat &res, const BasicBigFloat &a, const BasicBigFloat &b, char sign_);
+    static void subMagnitudes(BasicBigFloat &res, const BasicBigFloat &a, const BasicBigFloat &b, char sign_);
+    static void add(BasicBigFloat &res, const BasicBigFloat &a, const BasicBigFloat &b);
+    static void sub(BasicBigFloat &res, const BasicBigFloat &a, const BasicBigFloat &b);
+    static void mul(BasicBigFloat &res, const BasicBigFloat &a, const BasicBigFloat &b);
+    static void div(BasicBigFloat &res, const BasicBigFloat &x, const BasicBigFloat &y);
+    //Products and quotients good to `limbs` fractional limbs, see product() and quotient()
+    static void mulToLimbs(BasicBigFloat &res, const BasicBigFloat &a, const BasicBigFloat &b, int limbs);
+    static void divToLimbs(BasicBigFloat &res, const BasicBigFloat &x, const BasicBigFloat &y, int limbs);
+    //Zeroes the fractional limbs past the first `limbs`
+    void truncateFraction(int limbs);
+    static constexpr int limbsFor(int digits) { return std::clamp((digits + digitsPerLimb - 1) / digitsPerLimb, 0, fracLimbs); }
+    static BasicBigFloat sqrtOf(const BasicBigFloat &x);
+    static BasicBigFloat expOf(const BasicBigFloat &x);
+    static BasicBigFloat logOf(const BasicBigFloat &x);
+    static BasicBigFloat atanOf(const BasicBigFloat &x);
+    static BasicBigFloat powOf(const BasicBigFloat &x, const BasicBigFloat &y);
+    //Limbs after the dot computed past FracDigits, enough for a result good to the last digit
+    static constexpr int guardDigits = 2 * digitsPerLimb;
+
+    //Integers act through their magnitude and sign, so negative values of any integral type are handled
+    template<class Int>
+    static std::pair<uint64_t, char> splitInteger(Int k) {
+        if constexpr (std::is_signed_v<Int>) {
+            if (k < 0) {
+                return {0 - static_cast<uint64_t>(k), 1};
+            }
+        }
+        return {static_cast<uint64_t>(k), 0};
+    }
+    //Scalar operations in place, all of them single passes over the limbs
+    void mulWord(uint64_t k, char kSign);
+    void setInteger(uint64_t k, char kSign);
+    void divWord(uint64_t k, char kSign);
+    void addWord(uint64_t k, char kSign);
+    template<class Int>
+    using IfInteger = std::enable_if_t<std::is_integral_v<Int>, int>;
 
 public:
-    BigFloat& inverseSign();
-    friend BigFloat abs(const BigFloat &x);
-    explicit BigFloat(const std::vector<int> &intPart, const std::vector<int> &fracPart, char sign_);
-    explicit BigFloat(int x);
-    explicit BigFloat(const char* x);
+    BasicBigFloat& inverseSign();
+    friend BasicBigFloat abs(const BasicBigFloat &x) {
+        BasicBigFloat res = x;
+        res.sign = 0;
+        return res;
+    }
+    //fracPart must hold at least fracLimbs limbs, the ones past them are carried into the integer part
+    explicit BasicBigFloat(const std::vector<uint32_t> &intPart, const std::vector<uint32_t> &fracPart, char sign_);
+    //Any integral type, exactly
+    template<class Int, IfInteger<Int> = 0>
+    explicit BasicBigFloat(Int x) : integral(true) { auto [m, s] = splitInteger(x); setInteger(m, s); }
+    //The exact value of x truncated to FracDigits; infinities and NaN throw std::domain_error
+    explicit BasicBigFloat(double x);
+    explicit BasicBigFloat(const char* x);
+    //Changes precision: extra fractional limbs are truncated, missing ones are zero
+    template<int OtherDigits>
+    explicit BasicBigFloat(const BasicBigFloat<OtherDigits> &other);
+    //Copies the limbs of a view, its precision is changed the same way
+    explicit BasicBigFloat(const BigFloatView &other);
+    [[nodiscard]] BigFloatView view() const { return BigFloatView(sign, limbs.data(), limbs.size(), fracLimbs); }
+    //Raw limbs in the binary form of BigFloatBase::writeBinary, about 2.2 times smaller than the decimal text
+    //and copied rather than parsed. Values of another precision are truncated or padded on reading
+    void serialize(std::ostream &out) const;
+    static BasicBigFloat deserialize(std::istream &in);
     [[nodiscard]] std::string toString(size_t precision) const;
+    //Streams the digits of toString(precision) without building the whole string
+    void write(std::ostream &out, size_t precision) const;
+    void write(int fd, size_t precision) const;
 
-    friend BigFloat operator+(const BigFloat &a, const BigFloat &b);
-    friend BigFloat operator-(const BigFloat &a, const BigFloat &b);
-    bool operator >= (const BigFloat& other) const;
-    bool operator < (const BigFloat& other) const;
-    bool operator == (const BigFloat& other) const;
-    bool operator <= (const BigFloat& other) const;
-    bool operator != (const BigFloat& other) const;
-    bool operator > (const BigFloat& other) const;
-    BigFloat& operator -();
-    friend BigFloat operator*(const BigFloat &a, const BigFloat &b);
-    friend BigFloat operator/(const BigFloat &a, const BigFloat &b);
-    friend std::ostream& operator << (std::ostream &in, BigFloat &x);
-    friend void display(const BigFloat&x, size_t precision);
-    explicit operator double() const;
+    BasicBigFloat& operator += (const BasicBigFloat& other);
+    BasicBigFloat& operator -= (const BasicBigFloat& other);
+    BasicBigFloat& operator *= (const BasicBigFloat& other);
+    BasicBigFloat& operator /= (const BasicBigFloat& other);
+    //Overloads taking rvalues store the result in the storage of the temporary
+    friend BasicBigFloat operator+(const BasicBigFloat &a, const BasicBigFloat &b) { BasicBigFloat res; add(res, a, b); return res; }
+    friend BasicBigFloat operator+(BasicBigFloat &&a, const BasicBigFloat &b) { add(a, a, b); return std::move(a); }
+    friend BasicBigFloat operator+(const BasicBigFloat &a, BasicBigFloat &&b) { add(b, a, b); return std::move(b); }
+    friend BasicBigFloat operator+(BasicBigFloat &&a, BasicBigFloat &&b) { add(a, a, b); return std::move(a); }
+    friend BasicBigFloat operator-(const BasicBigFloat &a, const BasicBigFloat &b) { BasicBigFloat res; sub(res, a, b); return res; }
+    friend BasicBigFloat operator-(BasicBigFloat &&a, const BasicBigFloat &b) { sub(a, a, b); return std::move(a); }
+    friend BasicBigFloat operator-(const BasicBigFloat &a, BasicBigFloat &&b) { sub(b, a, b); return std::move(b); }
+    friend BasicBigFloat operator-(BasicBigFloat &&a, BasicBigFloat &&b) { sub(a, a, b); return std::move(a); }
+    //-1, 0 or 1 as *this is below, equal to or above other. Signs and top limbs decide most pairs,
+    //otherwise the limbs are read from the top down to the first difference
+    [[nodiscard]] int compare(const BasicBigFloat &other) const;
+    bool operator >= (const BasicBigFloat& other) const { return compare(other) >= 0; }
+    bool operator < (const BasicBigFloat& other) const { return compare(other) < 0; }
+    bool operator == (const BasicBigFloat& other) const;
+    bool operator <= (const BasicBigFloat& other) const { return compare(other) <= 0; }
+    bool operator != (const BasicBigFloat& other) const { return !(*this == other); }
+    bool operator > (const BasicBigFloat& other) const { return compare(other) > 0; }
+#if defined(__cpp_impl_three_way_comparison) && __cpp_impl_three_way_comparison >= 201907L && __has_include(<compare>)
+    std::strong_ordering operator <=> (const BasicBigFloat& other) const { return compare(other) <=> 0; }
+#endif
+    BasicBigFloat& operator -();
+    friend BasicBigFloat operator*(const BasicBigFloat &a, const BasicBigFloat &b) { BasicBigFloat res; mul(res, a, b); return res; }
+    friend BasicBigFloat operator*(BasicBigFloat &&a, const BasicBigFloat &b) { mul(a, a, b); return std::move(a); }
+    friend BasicBigFloat operator*(const BasicBigFloat &a, BasicBigFloat &&b) { mul(b, a, b); return std::move(b); }
+    friend BasicBigFloat operator*(BasicBigFloat &&a, BasicBigFloat &&b) { mul(a, a, b); return std::move(a); }
+    friend BasicBigFloat operator/(const BasicBigFloat &a, const BasicBigFloat &b) { BasicBigFloat res; div(res, a, b); return res; }
+    friend BasicBigFloat operator/(BasicBigFloat &&a, const BasicBigFloat &b) { div(a, a, b); return std::move(a); }
+
+    template<class Int, IfInteger<Int> = 0>
+    BasicBigFloat& operator *= (Int k) { auto [m, s] = splitInteger(k); mulWord(m, s); return *this; }
+    template<class Int, IfInteger<Int> = 0>
+    BasicBigFloat& operator /= (Int k) { auto [m, s] = splitInteger(k); divWord(m, s); return *this; }
+    template<class Int, IfInteger<Int> = 0>
+    BasicBigFloat& operator += (Int k) { auto [m, s] = splitInteger(k); addWord(m, s); return *this; }
+    template<class Int, IfInteger<Int> = 0>
+    BasicBigFloat& operator -= (Int k) { auto [m, s] = splitInteger(k); addWord(m, 1 - s); return *this; }
+    template<class Int, IfInteger<Int> = 0>
+    friend BasicBigFloat operator*(BasicBigFloat a, Int k) { return std::move(a *= k); }
+    template<class Int, IfInteger<Int> = 0>
+    friend BasicBigFloat operator*(Int k, BasicBigFloat a) { return std::move(a *= k); }
+    template<class Int, IfInteger<Int> = 0>
+    friend BasicBigFloat operator/(BasicBigFloat a, Int k) { return std::move(a /= k); }
+    template<class Int, IfInteger<Int> = 0>
+    friend BasicBigFloat operator+(BasicBigFloat a, Int k) { return std::move(a += k); }
+    template<class Int, IfInteger<Int> = 0>
+    friend BasicBigFloat operator+(Int k, BasicBigFloat a) { return std::move(a += k); }
+    template<class Int, IfInteger<Int> = 0>
+    friend BasicBigFloat operator-(BasicBigFloat a, Int k) { return std::move(a -= k); }
+    //k - a = -(a - k)
+    template<class Int, IfInteger<Int> = 0>
+    friend BasicBigFloat operator-(Int k, BasicBigFloat a) { a -= k; return std::move(a.inverseSign()); }
+    //Repeated squaring, about 2 log2(n) multiplications. Every product is truncated to the precision
+    friend BasicBigFloat pow(BasicBigFloat x, unsigned n) {
+        BasicBigFloat res(1);
+        while (n) {
+            if (n & 1) {
+                res *= x;
+            }
+            n >>= 1;
+            if (n) {
+                x *= x;
+            }
+        }
+        return res;
+    }
+    //Elementary functions, all truncated to the precision. Costs are in multiplications at the working precision,
+    //which is FracDigits plus a few guard limbs. Square root: Newton iteration for 1 / sqrt(x) that only multiplies,
+    //then one product with x, about 8 multiplications in total
+    friend BasicBigFloat sqrt(const BasicBigFloat &x) { return sqrtOf(x); }
+    //exp(x / 2^s) by its Taylor series and s squarings, about 2 sqrt(3.3 FracDigits) multiplications.
+    //Results above 10^18 keep about FracDigits + 18 significant digits rather than all fractional ones
+    friend BasicBigFloat exp(const BasicBigFloat &x) { return expOf(x); }
+    //Arithmetic-geometric mean, log2(FracDigits) + 3 steps of a multiplication and a square root, about
+    //9 (log2(FracDigits) + 3) multiplications of 1.5 times the precision, plus pi and ln 2 from the constants cache
+    friend BasicBigFloat log(const BasicBigFloat &x) { return logOf(x); }
+    //s halvings x / (1 + sqrt(1 + x^2)) then the Taylor series, about 2 sqrt(21 FracDigits) multiplications
+    friend BasicBigFloat atan(const BasicBigFloat &x) { return atanOf(x); }
+    //exp(y log x) for x > 0, pow(x, unsigned) is exact and cheaper for integer exponents
+    friend BasicBigFloat pow(const BasicBigFloat &x, const BasicBigFloat &y) { return powOf(x, y); }
+    //a * b and x / y good to `digits` digits after the dot (rounded up to whole limbs), the ones past them are zero.
+    //Operand limbs that cannot reach those digits are never read, so intermediates that need few digits, or whose
+    //operands are small, cost only what they need. Results differ from the exact ones by less than two units of the
+    //last kept limb, so they may not match a * b and x / y in the last digits
+    friend BasicBigFloat product(const BasicBigFloat &a, const BasicBigFloat &b, int digits) {
+        BasicBigFloat res;
+        mulToLimbs(res, a, b, limbsFor(digits));
+        return res;
+    }
+    friend BasicBigFloat quotient(const BasicBigFloat &x, const BasicBigFloat &y, int digits) {
+        BasicBigFloat res;
+        divToLimbs(res, x, y, limbsFor(digits));
+        return res;
+    }
+    //Decimal exponent of the leading digit, |x| is in [10^m, 10^(m + 1)). INT_MIN for zero.
+    //Series can compare it with their target to stop, or to pick the precision of the next term
+    [[nodiscard]] int magnitude() const;
+    //1 / x computed once, so a * x.reciprocal() replaces a division by a multiplication (last digit may differ)
+    [[nodiscard]] BasicBigFloat reciprocal() const;
+    friend std::ostream& operator << (std::ostream &out, const BasicBigFloat &x) {
+        x.write(out, sizeOfFracPart);
+        return out;
+    }
+    friend void display(const BasicBigFloat &x, size_t precision) {
+        x.write(std::cout, precision);
+        std::cout << '\n';
+    }
+    //Nearest double, ties to even; values past the double range give infinities or zeroes
+    [[nodiscard]] double toDouble() const { return BigFloatBase::toDouble(sign, limbs.data(), limbs.size(), fracLimbs); }
+    //Integer part, truncated towards zero. Throws std::overflow_error outside the int64_t range
+    [[nodiscard]] int64_t toInt64() const;
+    //Cheap double close to the value, for seeding iterations: it reads three limbs and is off by a few ulps
+    [[nodiscard]] double estimate() const { return BigFloatBase::estimate(sign, limbs.data(), limbs.size(), fracLimbs); }
+    explicit operator double() const { return toDouble(); }
 };
 
+using BigFloat = BasicBigFloat<128>;
+
 BigFloat operator""_bf(const char *s);
+
+//Sum of many values with a single carry propagation. Every limb of a term goes into a signed 64-bit lane of its own
+//and the lanes are only normalised when they could overflow or when the result is read, so a term costs one pass
+//of plain additions. Accumulators filled on different threads merge lane by lane
+template<int FracDigits>
+class BasicBigFloatAccumulator : public BigFloatBase {
+    template<int> friend class BasicBigFloatArray;
+public:
+    using Number = BasicBigFloat<FracDigits>;
+    BasicBigFloatAccumulator& operator += (const Number &x) { add(x, x.sign); return *this; }
+    BasicBigFloatAccumulator& operator -= (const Number &x) { add(x, 1 - x.sign); return *this; }
+    BasicBigFloatAccumulator& operator += (const BasicBigFloatAccumulator &other);
+    [[nodiscard]] Number result() const;
+    void clear();
+
+private:
+    //Normalised lanes are below base in magnitude and a term adds less than base to each of them
+    static constexpr uint64_t maxPending = INT64_MAX / base - 1;
+    std::vector<int64_t> lanes;
+    uint64_t pending = 0;
+
+    void add(const Number &x, char sign) { add(x.limbs.data(), x.limbs.size(), sign); }
+    //Adds n limbs laid out like those of Number
+    void add(const uint32_t *limbs, size_t n, char sign);
+    //Carries every lane but the top one into [0, base), the top one keeps the sign of the sum
+    void normalise();
+};
+
+using BigFloatAccumulator = BasicBigFloatAccumulator<128>;
+
+template<size_t... J>
+uint64_t BigFloatBase::mulRow(uint32_t xi, const uint32_t *y, uint32_t *res, std::index_sequence<J...>) {
+    uint64_t carry = 0;
+    ((carry += res[J] + static_cast<uint64_t>(xi) * y[J], res[J] = carry % base, carry /= base), ...);
+    return carry;
+}
+//Schoolbook product of two N-limb numbers into 2N limbs with the inner loop fully unrolled
+template<size_t N>
+void BigFloatBase::naive_mul_fixed(const uint32_t *x, const uint32_t *y, uint32_t *res) {
+    StatsScope scope(Counter::NaiveMul);
+    std::fill(res, res + 2 * N, 0);
+    for (size_t i = 0; i < N; ++i) {
+        if (x[i] == 0) {
+            continue;
+        }
+        res[i + N] = mulRow(x[i], y, res + i, std::make_index_sequence<N>());
+    }
+}
+//Karatsuba split resolved at compile time, every buffer lives on the stack
+template<size_t N>
+void BigFloatBase::karatsuba_mul_fixed(const uint32_t *x, const uint32_t *y, uint32_t *res) {
+    if constexpr (N <= naiveLimit) {
+        naive_mul_fixed<N>(x, y, res);
+    } else {
+        StatsScope scope(Counter::KaratsubaMul);
+        constexpr size_t k = N / 2, h = N - k;
+        std::array<uint32_t, h + 1> Xlr{}, Ylr{};
+        uint32_t cx = 0, cy = 0;
+        for (size_t i = 0; i < h; ++i) {
+            uint32_t sx = x[k + i] + (i < k ? x[i] : 0) + cx;
+            uint32_t sy = y[k + i] + (i < k ? y[i] : 0) + cy;
+            cx = sx >= base;
+            cy = sy >= base;
+            Xlr[i] = cx ? sx - base : sx;
+            Ylr[i] = cy ? sy - base : sy;
+        }
+        Xlr[h] = cx;
+        Ylr[h] = cy;
+        std::array<uint32_t, 2 * (h + 1)> P3;
+        karatsuba_mul_fixed<h + 1>(Xlr.data(), Ylr.data(), P3.data());
+        //res = P2 + P1 * base^(2k), both halves are written in place
+        karatsuba_mul_fixed<k>(x, y, res);
+        karatsuba_mul_fixed<h>(x + k, y + k, res + 2 * k);
+        //P3 -= P1 + P2
+        uint32_t loan1 = 0, loan2 = 0;
+        for (size_t i = 0; i < P3.size(); ++i) {
+            uint32_t p1 = (i < 2 * h ? res[2 * k + i] : 0) + loan1;
+            uint32_t p2 = (i < 2 * k ? res[i] : 0) + loan2;
+            loan1 = P3[i] < p1;
+            P3[i] = loan1 ? P3[i] + base - p1 : P3[i] - p1;
+            loan2 = P3[i] < p2;
+            P3[i] = loan2 ? P3[i] + base - p2 : P3[i] - p2;
+        }
+        uint32_t carry = 0;
+        for (size_t i = k; i < 2 * N; ++i) {
+            uint32_t cur = res[i] + (i - k < P3.size() ? P3[i - k] : 0) + carry;
+            carry = cur >= base;
+            res[i] = carry ? cur - base : cur;
+        }
+    }
+}
+
+template<int FracDigits>
+bool BasicBigFloat<FracDigits>::fractionIsZero() const {
+    return std::all_of(limbs.begin(), limbs.begin() + fracLimbs, [](uint32_t limb) { return limb == 0; });
+}
+template<int FracDigits>
+void BasicBigFloat<FracDigits>::canonicalise() {
+    trim();
+    top = static_cast<ptrdiff_t>(limbs.size()) - 1;
+    //Only the fraction of a value below 1 can hold zero limbs under the top one
+    const ptrdiff_t first = integral ? fracLimbs : 0;
+    while (top >= first && limbs[top] == 0) {
+        --top;
+    }
+    if (top < first) {
+        top = -1;
+        sign = 0;
+    }
+}
+template<int FracDigits>
+int BasicBigFloat<FracDigits>::magnitude() const {
+    if (top < 0) {
+        return INT_MIN;
+    }
+    int m = static_cast<int>(top - fracLimbs) * digitsPerLimb;
+    for (uint32_t limb = limbs[top]; limb >= 10; limb /= 10) {
+        ++m;
+    }
+    return m;
+}
+template<int FracDigits>
+void BasicBigFloat<FracDigits>::truncateFraction(int limbs_) {
+    if (limbs_ < fracLimbs) {
+        std::fill(limbs.begin(), limbs.begin() + (fracLimbs - limbs_), 0);
+        if (top < fracLimbs - limbs_) {
+            canonicalise();
+        }
+    }
+}
+template<int FracDigits>
+void BasicBigFloat<FracDigits>::trim() {
+    while (limbs.size() > fracLimbs + 1 && limbs.back() == 0) {
+        limbs.pop_back();
+    }
+}
+template<int FracDigits>
+void BasicBigFloat<FracDigits>::setZero() {
+    sign = 0;
+    integral = true;
+    top = -1;
+    limbs.resize(fracLimbs + 1);
+    std::fill(limbs.begin(), limbs.end(), 0);
+}
+template<int FracDigits>
+void BasicBigFloat<FracDigits>::assign(BasicBigFloat &res, const uint32_t *limbs, size_t size, size_t offset, char sign_) {
+    while (size > offset + fracLimbs + 1 && limbs[size - 1] == 0) {
+        --size;
+    }
+    res.sign = sign_;
+    res.integral = false;
+    res.limbs.assign(limbs + offset, limbs + size);
+    if (res.limbs.size() < fracLimbs + 1) {
+        res.limbs.resize(fracLimbs + 1);
+    }
+    res.canonicalise();
+}
+template<int FracDigits>
+BasicBigFloat<FracDigits>& BasicBigFloat<FracDigits>::inverseSign() {
+    if (top >= 0) {
+        sign = 1 - sign;
+    }
+    return *this;
+}
+template<int FracDigits>
+BasicBigFloat<FracDigits>::BasicBigFloat(const std::vector<uint32_t> &intPart, const std::vector<uint32_t> &fracPart, char sign_) : sign(sign_) {
+    limbs.resize(fracLimbs + std::max<size_t>(intPart.size(), 1));
+    std::copy(fracPart.begin(), fracPart.begin() + fracLimbs, limbs.begin());
+    std::copy(intPart.begin(), intPart.end(), limbs.begin() + fracLimbs);
+    if (fracPart.size() > fracLimbs) {
+        size_t extra = fracPart.size() - fracLimbs;
+        limbs.resize(std::max(limbs.size(), fracLimbs + extra) + 1);
+        uint32_t *integerPart = limbs.data() + fracLimbs;
+        sum(integerPart, integerPart, intSize(), fracPart.data() + fracLimbs, extra);
+    }
+    integral = fractionIsZero();
+    canonicalise();
+}
+template<int FracDigits>
+void BasicBigFloat<FracDigits>::setInteger(uint64_t k, char kSign) {
+    sign = k == 0 ? 0 : kSign;
+    //A 64-bit integer takes at most three limbs, sized up front so heap-backed precisions allocate once
+    size_t n = k < base ? 1 : k / base < base ? 2 : 3;
+    limbs.resize(fracLimbs + n);
+    std::fill(limbs.begin(), limbs.begin() + fracLimbs, 0);
+    for (size_t i = 0; i < n; ++i, k /= base) {
+        limbs[fracLimbs + i] = k % base;
+    }
+    top = limbs.back() == 0 ? -1 : static_cast<ptrdiff_t>(limbs.size()) - 1;
+}
+template<int FracDigits>
+BasicBigFloat<FracDigits>::BasicBigFloat(double x) {
+    Scratch scratch;
+    uint32_t *converted = scratch.alloc(fracLimbs + doubleIntLimbs);
+    limbs.assign(converted, converted + fromDouble(x, sign, converted, fracLimbs));
+    integral = fractionIsZero();
+    canonicalise();
+}
+template<int FracDigits>
+BasicBigFloat<FracDigits>::BasicBigFloat(const char *x) {
+    size_t intLimbs = parsedIntLimbs(x);
+    limbs.resize(fracLimbs + intLimbs);
+    parse(x, sign, limbs.data(), intLimbs, fracLimbs);
+    integral = fractionIsZero();
+    canonicalise();
+}
+template<int FracDigits>
+template<int OtherDigits>
+BasicBigFloat<FracDigits>::BasicBigFloat(const BasicBigFloat<OtherDigits> &other) : BasicBigFloat(other.view()) {
+    integral = other.integral;
+}
+template<int FracDigits>
+BasicBigFloat<FracDigits>::BasicBigFloat(const BigFloatView &other) : sign(other.sign()), integral(false) {
+    int common = std::min(fracLimbs, other.fracLimbs());
+    limbs.resize(fracLimbs + other.size() - other.fracLimbs());
+    std::copy(other.limbs() + (other.fracLimbs() - common), other.limbs() + other.size(), limbs.begin() + (fracLimbs - common));
+    canonicalise();
+}
+template<int FracDigits>
+void BasicBigFloat<FracDigits>::addMagnitudes(BasicBigFloat &res, const BasicBigFloat &a, const BasicBigFloat &b, char sign_) {
+    size_t an = a.limbs.size(), bn = b.limbs.size();
+    res.limbs.resize(std::max(an, bn));
+    uint32_t carry = sum(res.limbs.data(), a.limbs.data(), an, b.limbs.data(), bn);
+    if (carry) {
+        res.limbs.push_back(carry);
+    }
+    res.sign = sign_;
+    res.integral = a.integral && b.integral;
+    res.canonicalise();
+}
+//||a| - |b||, the sign flips when |a| < |b|
+template<int FracDigits>
+void BasicBigFloat<FracDigits>::subMagnitudes(BasicBigFloat &res, const BasicBigFloat &a, const BasicBigFloat &b, char sign_) {
+    bool less = compareMagnitudes(a, b) < 0;
+    const BasicBigFloat &x = less ? b : a;
+    const BasicBigFloat &y = less ? a : b;
+    size_t xn = x.limbs.size(), yn = std::min(xn, y.limbs.size());
+    res.limbs.resize(xn);
+    substract(res.limbs.data(), x.limbs.data(), xn, y.limbs.data(), yn);
+    res.sign = less ? 1 - sign_ : sign_;
+    res.integral = a.integral && b.integral;
+    res.canonicalise();
+}
+template<int FracDigits>
+void BasicBigFloat<FracDigits>::add(BasicBigFloat &res, const BasicBigFloat &a, const BasicBigFloat &b) {
+    if (a.sign == b.sign) {
+        addMagnitudes(res, a, b, a.sign);
+    } else {
+        subMagnitudes(res, a, b, a.sign);
+    }
+}
+template<int FracDigits>
+void BasicBigFloat<FracDigits>::sub(BasicBigFloat &res, const BasicBigFloat &a, const BasicBigFloat &b) {
+    if (a.sign != b.sign) {
+        addMagnitudes(res, a, b, a.sign);
+    } else {
+        subMagnitudes(res, a, b, a.sign);
+    }
+}
+template<int FracDigits>
+BasicBigFloat<FracDigits>& BasicBigFloat<FracDigits>::operator += (const BasicBigFloat &other) {
+    add(*this, *this, other);
+    return *this;
+}
+template<int FracDigits>
+BasicBigFloat<FracDigits>& BasicBigFloat<FracDigits>::operator -= (const BasicBigFloat &other) {
+    sub(*this, *this, other);
+    return *this;
+}
+template<int FracDigits>
+BasicBigFloat<FracDigits>& BasicBigFloat<FracDigits>::operator *= (const BasicBigFloat &other) {
+    mul(*this, *this, other);
+    return *this;
+}
+template<int FracDigits>
+BasicBigFloat<FracDigits>& BasicBigFloat<FracDigits>::operator /= (const BasicBigFloat &other) {
+    div(*this, *this, other);
+    return *this;
+}
+//Both values share the limb layout, so the higher top limb is the larger magnitude
+template<int FracDigits>
+int BasicBigFloat<FracDigits>::compareMagnitudes(const BasicBigFloat &a, const BasicBigFloat &b) {
+    if (a.top != b.top) {
+        return a.top < b.top ? -1 : 1;
+    }
+    for (ptrdiff_t i = a.top; i >= 0; --i) {
+        if (a.limbs[i] != b.limbs[i]) {
+            return a.limbs[i] < b.limbs[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+template<int FracDigits>
+int BasicBigFloat<FracDigits>::compare(const BasicBigFloat &other) const {
+    int s = top < 0 ? 0 : sign ? -1 : 1, otherS = other.top < 0 ? 0 : other.sign ? -1 : 1;
+    if (s != otherS) {
+        return s < otherS ? -1 : 1;
+    }
+    return s * compareMagnitudes(*this, other);
+}
+//Equal values have the same top limb and sign, then the limbs are compared as one block
+template<int FracDigits>
+bool BasicBigFloat<FracDigits>::operator == (const BasicBigFloat &other) const {
+    return top == other.top && sign == other.sign && std::equal(limbs.begin(), limbs.begin() + (top + 1), other.limbs.begin());
+}
+template<int FracDigits>
+BasicBigFloat<FracDigits>& BasicBigFloat<FracDigits>::operator -() {
+    return inverseSign();
+}
+template<int FracDigits>
+void BasicBigFloat<FracDigits>::mul(BasicBigFloat &res, const BasicBigFloat &a, const BasicBigFloat &b) {
+    if (a.isZero() || b.isZero()) {
+        res.setZero();
+        return;
+    }
+    //The product is formed in temporary memory first, so res may be an operand
+    char sign_ = a.sign ^ b.sign;
+    //A whole factor multiplies the limbs of the other one as an integer and keeps its scale
+    if (a.integral || b.integral) {
+        const BasicBigFloat &whole = a.integral ? a : b, &other = a.integral ? b : a;
+        size_t wholeSize = whole.intSize();
+        bool integral_ = a.integral && b.integral;
+        if (wholeSize == 1) {
+            uint32_t k = whole.limbs[fracLimbs];
+            if (&res != &other) {
+                res = other;
+            }
+            res.mulWord(k, sign_ ^ res.sign);
+            res.integral = integral_;
+            return;
+        }
+        Scratch scratch;
+        size_t size = other.limbs.size() + wholeSize;
+        uint32_t *product = scratch.alloc(size);
+        mult(product, other.limbs.data(), other.limbs.size(), whole.limbs.data() + fracLimbs, wholeSize);
+        assign(res, product, size, 0, sign_);
+        res.integral = integral_;
+        return;
+    }
+    //Values below base share one compile-time product shape
+    if constexpr (inlineFraction) {
+        if (a.intSize() == 1 && b.intSize() == 1) {
+            std::array<uint32_t, 2 * (fracLimbs + 1)> product;
+            karatsuba_mul_fixed<fracLimbs + 1>(a.limbs.data(), b.limbs.data(), product.data());
+            assign(res, product.data(), product.size(), fracLimbs, sign_);
+            return;
+        }
+    }
+    Scratch scratch;
+    size_t size = a.limbs.size() + b.limbs.size();
+    uint32_t *product = scratch.alloc(size);
+    mult(product, a.limbs.data(), a.limbs.size(), b.limbs.data(), b.limbs.size());
+    assign(res, product, size, fracLimbs, sign_);
+}
+//Limbs i of a and j of b land on limb i + j of the double-width product, whose limb 2F - limbs is the last one kept.
+//Dropping the ka low limbs of a changes the product by less than base^(ka + tb + 1) for b below base^(tb + 1),
+//so both operands lose every limb that stays under limb low = 2F - limbs - 1; together that is under two units of
+//the guard limb below the last kept one
+template<int FracDigits>
+void BasicBigFloat<FracDigits>::mulToLimbs(BasicBigFloat &res, const BasicBigFloat &a, const BasicBigFloat &b, int limbs_) {
+    if (a.integral || b.integral) {
+        mul(res, a, b);
+        res.truncateFraction(limbs_);
+        return;
+    }
+    ptrdiff_t ta = a.topLimb(), tb = b.topLimb();
+    ptrdiff_t low = 2 * fracLimbs - limbs_ - 1;
+    if (ta < 0 || tb < 0 || ta + tb + 2 <= low) {
+        res.setZero();
+        return;
+    }
+    size_t ka = std::max<ptrdiff_t>(0, low - tb - 1), kb = std::max<ptrdiff_t>(0, low - ta - 1);
+    size_t an = a.limbs.size() - ka, bn = b.limbs.size() - kb;
+    //Limb ka + kb of the full product is the first one formed, it lands on product[pad]
+    size_t shift = ka + kb, pad = shift > fracLimbs ? shift - fracLimbs : 0;
+    char sign_ = a.sign ^ b.sign;
+    Scratch scratch;
+    size_t size = pad + an + bn;
+    uint32_t *product = scratch.alloc(size);
+    std::fill(product, product + pad, 0);
+    mult(product + pad, a.limbs.data() + ka, an, b.limbs.data() + kb, bn);
+    assign(res, product, size, fracLimbs + pad - shift, sign_);
+    res.truncateFraction(limbs_);
+}
+//The quotient is below base^(tx - ty + 1) in units of base^-F, so it has m = tx - ty + limbs + 2 limbs down to the
+//guard limb past the last kept one. The top m + 1 limbs of each operand give it with a relative error of 2 base^-m
+template<int FracDigits>
+void BasicBigFloat<FracDigits>::divToLimbs(BasicBigFloat &res, const BasicBigFloat &x, const BasicBigFloat &y, int limbs_) {
+    if (y.isZero()) {
+        diagnostic("Division by zero");
+        throw std::runtime_error("Division by zero");
+    }
+    if (x.isZero() || (y.integral && y.intSize() == 1)) {
+        div(res, x, y);
+        res.truncateFraction(limbs_);
+        return;
+    }
+    ptrdiff_t tx = x.topLimb(), ty = y.topLimb();
+    ptrdiff_t m = tx - ty + limbs_ + 2;
+    if (m <= 0) {
+        res.setZero();
+        return;
+    }
+    ptrdiff_t kx = std::max<ptrdiff_t>(0, tx - m), ky = std::max<ptrdiff_t>(0, ty - m);
+    LimbVector num(x.limbs.begin() + kx, x.limbs.end()), den(y.limbs.begin() + ky, y.limbs.end());
+    //floor(x * base^(limbs + 1) / y) with the dropped limbs folded into the scale
+    ptrdiff_t e = kx - ky + limbs_ + 1;
+    num = shifted(num, std::max<ptrdiff_t>(e, 0));
+    den = shifted(den, std::max<ptrdiff_t>(-e, 0));
+    BigFloatBase::trim(num);
+    BigFloatBase::trim(den);
+    LimbVector q = divide(num, den);
+    ptrdiff_t guard = limbs_ + 1 - fracLimbs;
+    q = shifted(q, std::max<ptrdiff_t>(-guard, 0));
+    assign(res, q.data(), q.size(), std::max<ptrdiff_t>(guard, 0), x.sign ^ y.sign);
+    res.truncateFraction(limbs_);
+}
+template<int FracDigits>
+void BasicBigFloat<FracDigits>::div(BasicBigFloat &res, const BasicBigFloat &x, const BasicBigFloat &y) {
+    if (y.isZero()) {
+        diagnostic("Division by zero");
+        throw std::runtime_error("Division by zero");
+    }
+    if (x.isZero()) {
+        res.setZero();
+        return;
+    }
+    //Divisors below base are a single short division
+    if (y.integral && y.intSize() == 1) {
+        uint32_t k = y.limbs[fracLimbs];
+        char ySign = y.sign;
+        if (&res != &x) {
+            res = x;
+        }
+        res.divWord(k, ySign);
+        return;
+    }
+    LimbVector q = divideFixedPoint(LimbVector(x.limbs.begin(), x.limbs.end()), LimbVector(y.limbs.begin(), y.limbs.end()), fracLimbs);
+    assign(res, q.data(), q.size(), 0, x.sign ^ y.sign);
+}
+template<int FracDigits>
+BasicBigFloat<FracDigits> BasicBigFloat<FracDigits>::sqrtOf(const BasicBigFloat &x) {
+    if (x.sign && !x.isZero()) {
+        throw std::domain_error("Square root of a negative number");
+    }
+    LimbVector root = sqrtFixedPoint(LimbVector(x.limbs.begin(), x.limbs.end()), fracLimbs);
+    BasicBigFloat res;
+    assign(res, root.data(), root.size(), 0, 0);
+    return res;
+}
+template<int FracDigits>
+BasicBigFloat<FracDigits> BasicBigFloat<FracDigits>::expOf(const BasicBigFloat &x) {
+    constexpr int s = halvings(FracDigits, 1);
+    //Every squaring doubles the relative error, the guard grows by log10(2^s) digits to absorb that
+    constexpr int workDigits = FracDigits + guardDigits + s * 3 / 10;
+    using Wide = BasicBigFloat<workDigits>;
+    Wide r(x), one(1);
+    int squarings = s;
+    while (abs(r) >= one) {
+        r /= 2;
+        ++squarings;
+    }
+    for (int i = s; i > 0; i -= 60) {
+        r /= uint64_t(1) << std::min(i, 60);
+    }
+    //|r| < 2^-s, so every term gains s bits on the previous one
+    BasicBigFloatAccumulator<workDigits> terms;
+    Wide term = one;
+    terms += one;
+    //Terms shrink, and the limbs of r that only reach past the last fractional limb are skipped
+    for (uint64_t k = 1;; ++k) {
+        Wide::mulToLimbs(term, term, r, Wide::fracLimbs);
+        term /= k;
+        if (term.isZero()) {
+            break;
+        }
+        terms += term;
+    }
+    Wide sum = terms.result();
+    for (int i = 0; i < squarings; ++i) {
+        sum *= sum;
+    }
+    return BasicBigFloat(sum);
+}
+//ln s = pi / (2 AGM(1, 4 / s)) up to O(1 / s^2), so x is scaled to s = x 2^m past the square root of the precision.
+//AGM(1, 4 / s) = 4 / s AGM(s / 4, 1) keeps the operands large, where fixed point holds all their digits
+template<int FracDigits>
+BasicBigFloat<FracDigits> BasicBigFloat<FracDigits>::logOf(const BasicBigFloat &x) {
+    if (x.sign || x.isZero()) {
+        throw std::domain_error("Logarithm of a non-positive number");
+    }
+    constexpr int workDigits = FracDigits + guardDigits;
+    using Wide = BasicBigFloat<workDigits>;
+    //x >= 10^digits and log10(2) > 0.3
+    ptrdiff_t digits = (x.top - fracLimbs) * digitsPerLimb;
+    ptrdiff_t m = std::max<ptrdiff_t>(0, (Wide::sizeOfFracPart / 2 + 2 - digits) * 10 / 3 + 1);
+    Wide scaled(x);
+    for (ptrdiff_t i = m; i > 0; i -= 60) {
+        scaled *= uint64_t(1) << std::min<ptrdiff_t>(i, 60);
+    }
+    Wide a = scaled / 4, b(1);
+    std::vector<uint32_t> ulps(Wide::fracLimbs);
+    ulps[0] = 16;
+    Wide tolerance(std::vector<uint32_t>{0}, ulps, 0);
+    while (abs(a - b) > tolerance) {
+        Wide mean = (a + b) / 2;
+        b = sqrt(a * b);
+        a = std::move(mean);
+    }
+    LimbVector piLimbs = constantFixedPoint(Constant::Pi, Wide::fracLimbs);
+    LimbVector ln2Limbs = constantFixedPoint(Constant::Ln2, Wide::fracLimbs);
+    Wide pi, ln2;
+    Wide::assign(pi, piLimbs.data(), piLimbs.size(), 0, 0);
+    Wide::assign(ln2, ln2Limbs.data(), ln2Limbs.size(), 0, 0);
+    Wide res = pi * scaled / 8 / a - ln2 * m;
+    return BasicBigFloat(res);
+}
+template<int FracDigits>
+BasicBigFloat<FracDigits> BasicBigFloat<FracDigits>::atanOf(const BasicBigFloat &x) {
+    //A halving costs a square root and a division, about 13 terms. One extra brings |x| > 1 below tan(pi / 8)
+    constexpr int s = halvings(FracDigits, 26) + 1;
+    constexpr int workDigits = FracDigits + guardDigits + s * 3 / 10;
+    using Wide = BasicBigFloat<workDigits>;
+    //atan y = 2 atan(y / (1 + sqrt(1 + y^2)))
+    Wide y(x);
+    for (int i = 0; i < s; ++i) {
+        y = y / (sqrt(y * y + 1) + 1);
+    }
+    Wide y2 = y * y, power = y;
+    BasicBigFloatAccumulator<workDigits> terms;
+    terms += y;
+    for (uint64_t k = 1;; ++k) {
+        Wide::mulToLimbs(power, power, y2, Wide::fracLimbs);
+        if (power.isZero()) {
+            break;
+        }
+        Wide term = power / (2 * k + 1);
+        if (k & 1) {
+            terms -= term;
+        } else {
+            terms += term;
+        }
+    }
+    Wide sum = terms.result();
+    for (int i = s; i > 0; i -= 60) {
+        sum *= uint64_t(1) << std::min(i, 60);
+    }
+    return BasicBigFloat(sum);
+}
+template<int FracDigits>
+BasicBigFloat<FracDigits> BasicBigFloat<FracDigits>::powOf(const BasicBigFloat &x, const BasicBigFloat &y) {
+    if (x.sign && !x.isZero()) {
+        throw std::domain_error("Power of a negative number");
+    }
+    if (x.isZero()) {
+        if (y.sign && !y.isZero()) {
+            throw std::runtime_error("Division by zero");
+        }
+        return BasicBigFloat(y.isZero() ? 1 : 0);
+    }
+    //An error e in log x becomes a relative error y e of the power, the guard limbs keep it below the last digit
+    using Wide = BasicBigFloat<FracDigits + guardDigits>;
+    return BasicBigFloat(exp(log(Wide(x)) * Wide(y)));
+}
+template<int FracDigits>
+void BasicBigFloat<FracDigits>::mulWord(uint64_t k, char kSign) {
+    if (k == 0 || isZero()) {
+        setZero();
+        return;
+    }
+    uint64_t carry = mulByWord(limbs.data(), limbs.data(), limbs.size(), k);
+    for (; carry; carry /= base) {
+        limbs.push_back(carry % base);
+    }
+    sign ^= kSign;
+    canonicalise();
+}
+//The limbs are an integer scaled by base^fracLimbs, so short division of them is the fixed-point quotient
+template<int FracDigits>
+void BasicBigFloat<FracDigits>::divWord(uint64_t k, char kSign) {
+    if (k == 0) {
+        diagnostic("Division by zero");
+        throw std::runtime_error("Division by zero");
+    }
+    divideByWord(limbs.data(), limbs.size(), k);
+    sign ^= kSign;
+    integral = false;
+    canonicalise();
+}
+//Only the integer part is touched unless k is larger than a value of the opposite sign
+template<int FracDigits>
+void BasicBigFloat<FracDigits>::addWord(uint64_t k, char kSign) {
+    if (k == 0) {
+        return;
+    }
+    uint32_t word[3];
+    size_t kn = 0;
+    for (; k; k /= base) {
+        word[kn++] = k % base;
+    }
+    if (sign == kSign) {
+        if (intSize() < kn) {
+            limbs.resize(fracLimbs + kn);
+        }
+        uint32_t carry = sum(limbs.data() + fracLimbs, limbs.data() + fracLimbs, intSize(), word, kn);
+        if (carry) {
+            limbs.push_back(carry);
+        }
+        canonicalise();
+    } else if (BigFloatBase::compare(limbs.data() + fracLimbs, intSize(), word, kn) >= 0) {
+        substract(limbs.data() + fracLimbs, limbs.data() + fracLimbs, intSize(), word, kn);
+        canonicalise();
+    } else {
+        //|k| > |*this|, so *this is below 2^64 and the general path is cheap
+        BasicBigFloat other;
+        other.sign = kSign;
+        other.integral = true;
+        other.limbs.resize(fracLimbs + kn);
+        std::copy(word, word + kn, other.limbs.begin() + fracLimbs);
+        other.top = static_cast<ptrdiff_t>(other.limbs.size()) - 1;
+        add(*this, other, *this);
+    }
+}
+template<int FracDigits>
+BasicBigFloat<FracDigits> BasicBigFloat<FracDigits>::reciprocal() const {
+    return BasicBigFloat(1) / *this;
+}
+template<int FracDigits>
+std::string BasicBigFloat<FracDigits>::toString(size_t precision) const {
+    return format(sign, limbs.data(), limbs.size(), fracLimbs, precision);
+}
+template<int FracDigits>
+void BasicBigFloat<FracDigits>::write(std::ostream &out, size_t precision) const {
+    BigFloatBase::write(out, sign, limbs.data(), limbs.size(), fracLimbs, precision);
+}
+template<int FracDigits>
+void BasicBigFloat<FracDigits>::write(int fd, size_t precision) const {
+    BigFloatBase::write(fd, sign, limbs.data(), limbs.size(), fracLimbs, precision);
+}
+template<int FracDigits>
+void BasicBigFloat<FracDigits>::serialize(std::ostream &out) const {
+    writeBinary(out, sign, limbs.data(), limbs.size(), fracLimbs);
+}
+template<int FracDigits>
+BasicBigFloat<FracDigits> BasicBigFloat<FracDigits>::deserialize(std::istream &in) {
+    char sign_;
+    LimbVector read = readBinary(in, sign_, fracLimbs);
+    BasicBigFloat res;
+    assign(res, read.data(), read.size(), 0, sign_);
+    return res;
+}
+template<int FracDigits>
+int64_t BasicBigFloat<FracDigits>::toInt64() const {
+    //|x| < 2^63 < 10^19 takes at most three integer limbs, the top one at most 9
+    size_t n = intSize();
+    const uint32_t *integer = limbs.data() + fracLimbs;
+    uint64_t magnitude_ = 0;
+    if (n <= 3 && (n < 3 || integer[2] <= 9)) {
+        for (size_t i = n; i-- > 0;) {
+            magnitude_ = magnitude_ * base + integer[i];
+        }
+        uint64_t limit = uint64_t(INT64_MAX) + sign;
+        if (magnitude_ <= limit) {
+            return sign ? static_cast<int64_t>(0 - magnitude_) : static_cast<int64_t>(magnitude_);
+        }
+    }
+    throw std::overflow_error("BigFloat: value out of the int64_t range");
+}
+
+template<int FracDigits>
+void BasicBigFloatAccumulator<FracDigits>::add(const uint32_t *limbs, size_t n, char sign) {
+    if (pending >= maxPending) {
+        normalise();
+    }
+    if (lanes.size() < n) {
+        lanes.resize(n);
+    }
+    if (sign) {
+        for (size_t i = 0; i < n; ++i) lanes[i] -= limbs[i];
+    } else {
+        for (size_t i = 0; i < n; ++i) lanes[i] += limbs[i];
+    }
+    ++pending;
+}
+template<int FracDigits>
+BasicBigFloatAccumulator<FracDigits>& BasicBigFloatAccumulator<FracDigits>::operator += (const BasicBigFloatAccumulator &other) {
+    if (pending + other.pending > maxPending) {
+        normalise();
+    }
+    if (lanes.size() < other.lanes.size()) {
+        lanes.resize(other.lanes.size());
+    }
+    for (size_t i = 0; i < other.lanes.size(); ++i) lanes[i] += other.lanes[i];
+    pending += other.pending;
+    return *this;
+}
+template<int FracDigits>
+void BasicBigFloatAccumulator<FracDigits>::normalise() {
+    if (lanes.empty()) {
+        return;
+    }
+    if constexpr (statsEnabled) count(Counter::CarryPass);
+    int64_t carry = 0;
+    for (size_t i = 0; i + 1 < lanes.size(); ++i) {
+        int64_t v = lanes[i] + carry;
+        carry = v / base;
+        v %= base;
+        if (v < 0) {
+            v += base;
+            --carry;
+        }
+        lanes[i] = v;
+    }
+    lanes.back() += carry;
+    while (lanes.back() >= static_cast<int64_t>(base) || lanes.back() <= -static_cast<int64_t>(base)) {
+        int64_t top = lanes.back();
+        lanes.back() = top % base;
+        lanes.push_back(top / base);
+    }
+    pending = 1;
+}
+//The carry left after the top lane is negative exactly when the sum is, which is then carried again negated
+template<int FracDigits>
+BasicBigFloat<FracDigits> BasicBigFloatAccumulator<FracDigits>::result() const {
+    Number res;
+    if (lanes.empty()) {
+        res.setZero();
+        return res;
+    }
+    if constexpr (statsEnabled) count(Counter::CarryPass);
+    for (int64_t direction : {1, -1}) {
+        res.limbs.resize(lanes.size());
+        int64_t carry = 0;
+        for (size_t i = 0; i < lanes.size(); ++i) {
+            int64_t v = direction * lanes[i] + carry;
+            carry = v / base;
+            v %= base;
+            if (v < 0) {
+                v += base;
+                --carry;
+            }
+            res.limbs[i] = static_cast<uint32_t>(v);
+        }
+        if (carry >= 0) {
+            for (; carry; carry /= base) {
+                res.limbs.push_back(carry % base);
+            }
+            res.sign = direction < 0;
+            res.canonicalise();
+            return res;
+        }
+    }
+    return res;
+}
+template<int FracDigits>
+void BasicBigFloatAccumulator<FracDigits>::clear() {
+    lanes.clear();
+    pending = 0;
+}
+
+extern template class BasicBigFloat<128>;
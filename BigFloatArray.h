@@ -0,0 +1,372 @@
+#pragma once
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include "BigFloat.h"
+#include "TaskPool.h"
+
+//Many values of one precision in three flat buffers: the limbs, the limb counts and the signs. Element i keeps its
+//limbs at i * stride, fraction first like BasicBigFloat, and the stride grows with the widest integer part.
+//Batch operations compute every element into scratch memory and copy it into its slot, so they allocate nothing per
+//element and the result may be one of the operands. Elements are walked in tiles of about tileLimbs limbs, large
+//arrays are split into chunks across the library task pool
+template<int FracDigits>
+class BasicBigFloatArray : public BigFloatBase {
+public:
+    using Number = BasicBigFloat<FracDigits>;
+    static constexpr int fracLimbs = (FracDigits + digitsPerLimb - 1) / digitsPerLimb;
+
+    //n zeroes with room for intLimbs integer limbs each
+    explicit BasicBigFloatArray(size_t n = 0, size_t intLimbs = 1);
+    explicit BasicBigFloatArray(const std::vector<Number> &values);
+    [[nodiscard]] size_t size() const { return signs.size(); }
+    //The element in place, valid until the array is resized or an operation writes to it
+    [[nodiscard]] BigFloatView view(size_t i) const {
+        return BigFloatView(signs[i], limbs.data() + i * stride, sizes[i], fracLimbs);
+    }
+    [[nodiscard]] Number operator[](size_t i) const { return Number(view(i)); }
+    void set(size_t i, const Number &x);
+    void push_back(const Number &x);
+    //New elements are zero
+    void resize(size_t n);
+
+    //Element-wise res[i] = a[i] op b[i]. Operands of different sizes throw std::invalid_argument, res is resized
+    static void add(BasicBigFloatArray &res, const BasicBigFloatArray &a, const BasicBigFloatArray &b);
+    static void sub(BasicBigFloatArray &res, const BasicBigFloatArray &a, const BasicBigFloatArray &b);
+    static void mul(BasicBigFloatArray &res, const BasicBigFloatArray &a, const BasicBigFloatArray &b);
+    //res[i] = a[i] * b[i] + c[i], truncated once from the exact value
+    static void fma(BasicBigFloatArray &res, const BasicBigFloatArray &a, const BasicBigFloatArray &b,
+                    const BasicBigFloatArray &c);
+    //y[i] += alpha * x[i], truncated once from the exact value
+    static void axpy(BasicBigFloatArray &y, const Number &alpha, const BasicBigFloatArray &x);
+    //Sum of a[i] * b[i]: the exact products go into one accumulator per chunk and are truncated once at the end
+    [[nodiscard]] static Number dot(const BasicBigFloatArray &a, const BasicBigFloatArray &b);
+
+private:
+    //Limbs of the operands a tile touches, small enough for them to stay in the L2 cache
+    static constexpr size_t tileLimbs = 1 << 14;
+    //Holds the products of dot exactly, with twice the fractional limbs
+    using WideAccumulator = BasicBigFloatAccumulator<2 * fracLimbs * digitsPerLimb>;
+    //Chunks of element-wise operations have nothing to merge
+    struct NoPartial {
+        NoPartial &operator+=(const NoPartial &) { return *this; }
+    };
+
+    LimbVector limbs;
+    std::vector<uint32_t> sizes;
+    std::vector<char> signs;
+    size_t stride;
+
+    [[nodiscard]] const uint32_t *at(size_t i) const { return limbs.data() + i * stride; }
+    [[nodiscard]] size_t maxIntLimbs() const;
+    //Widens every slot to fracLimbs + intLimbs limbs, does nothing when they are that wide already
+    void reserveIntLimbs(size_t intLimbs);
+    void store(size_t i, const uint32_t *x, size_t n, char sign);
+    static void checkSizes(size_t a, size_t b);
+    //Limb counts above fracLimbs + 1 without leading zeroes
+    static size_t trimmed(const uint32_t *x, size_t n);
+    //The kernels take values with fracLimbs fractional limbs, write the result to res, which must not overlap them,
+    //and return its trimmed size with the sign of zero cleared.
+    //res = a + b (b negated when bs says so), max(an, bn) + 1 limbs
+    static size_t addKernel(uint32_t *res, char &sign, const uint32_t *a, size_t an, char as,
+                            const uint32_t *b, size_t bn, char bs);
+    //res = a * b + c, truncated once; cn = 0 leaves c out. work holds an + bn + 1 limbs and res
+    //max(an + bn, fracLimbs + cn) + 1
+    static size_t fmaKernel(uint32_t *res, uint32_t *work, char &sign, const uint32_t *a, size_t an, char as,
+                            const uint32_t *b, size_t bn, char bs, const uint32_t *c, size_t cn, char cs);
+    //Calls fn(begin, end, partial) on chunks of [0, n) of at most a tile each, chunks of large arrays on several
+    //threads with partials of their own that are merged into partial
+    template<class Partial, class Fn>
+    static void forTiles(size_t n, size_t elementLimbs, Partial &partial, Fn fn);
+    template<class Partial, class Fn>
+    static void forTilesRange(size_t begin, size_t end, size_t grain, size_t tile, Partial &partial, Fn &fn);
+};
+
+using BigFloatArray = BasicBigFloatArray<128>;
+
+template<int FracDigits>
+BasicBigFloatArray<FracDigits>::BasicBigFloatArray(size_t n, size_t intLimbs)
+    : limbs(n * (fracLimbs + std::max<size_t>(intLimbs, 1))), sizes(n, fracLimbs + 1), signs(n, 0),
+      stride(fracLimbs + std::max<size_t>(intLimbs, 1)) {}
+template<int FracDigits>
+BasicBigFloatArray<FracDigits>::BasicBigFloatArray(const std::vector<Number> &values) : BasicBigFloatArray() {
+    size_t intLimbs = 1;
+    for (const Number &x : values) {
+        intLimbs = std::max(intLimbs, x.view().size() - fracLimbs);
+    }
+    reserveIntLimbs(intLimbs);
+    resize(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        set(i, values[i]);
+    }
+}
+template<int FracDigits>
+void BasicBigFloatArray<FracDigits>::set(size_t i, const Number &x) {
+    BigFloatView v = x.view();
+    reserveIntLimbs(v.size() - fracLimbs);
+    store(i, v.limbs(), v.size(), v.sign());
+}
+template<int FracDigits>
+void BasicBigFloatArray<FracDigits>::push_back(const Number &x) {
+    resize(size() + 1);
+    set(size() - 1, x);
+}
+template<int FracDigits>
+void BasicBigFloatArray<FracDigits>::resize(size_t n) {
+    size_t old = size();
+    limbs.resize(n * stride);
+    sizes.resize(n, fracLimbs + 1);
+    signs.resize(n, 0);
+    if (n > old) {
+        std::fill(limbs.begin() + old * stride, limbs.end(), 0);
+    }
+}
+
+template<int FracDigits>
+size_t BasicBigFloatArray<FracDigits>::maxIntLimbs() const {
+    uint32_t widest = fracLimbs + 1;
+    for (uint32_t n : sizes) widest = std::max(widest, n);
+    return widest - fracLimbs;
+}
+template<int FracDigits>
+void BasicBigFloatArray<FracDigits>::reserveIntLimbs(size_t intLimbs) {
+    size_t wider = fracLimbs + intLimbs;
+    if (wider <= stride) {
+        return;
+    }
+    LimbVector moved(size() * wider);
+    for (size_t i = 0; i < size(); ++i) {
+        std::copy(at(i), at(i) + sizes[i], moved.data() + i * wider);
+    }
+    limbs.swap(moved);
+    stride = wider;
+}
+template<int FracDigits>
+void BasicBigFloatArray<FracDigits>::store(size_t i, const uint32_t *x, size_t n, char sign) {
+    std::copy(x, x + n, limbs.data() + i * stride);
+    sizes[i] = static_cast<uint32_t>(n);
+    signs[i] = sign;
+}
+template<int FracDigits>
+void BasicBigFloatArray<FracDigits>::checkSizes(size_t a, size_t b) {
+    if (a != b) {
+        throw std::invalid_argument("BigFloatArray operands differ in size");
+    }
+}
+template<int FracDigits>
+size_t BasicBigFloatArray<FracDigits>::trimmed(const uint32_t *x, size_t n) {
+    while (n > fracLimbs + 1 && x[n - 1] == 0) --n;
+    return n;
+}
+
+template<int FracDigits>
+size_t BasicBigFloatArray<FracDigits>::addKernel(uint32_t *res, char &sign, const uint32_t *a, size_t an, char as,
+                                                 const uint32_t *b, size_t bn, char bs) {
+    size_t n = std::max(an, bn);
+    if (as == bs) {
+        res[n] = sum(res, a, an, b, bn);
+        ++n;
+        sign = as;
+    } else if (compare(a, an, b, bn) >= 0) {
+        //Trimmed values are at least as long as the smaller ones
+        substract(res, a, an, b, bn);
+        sign = as;
+    } else {
+        substract(res, b, bn, a, an);
+        sign = bs;
+    }
+    n = trimmed(res, n);
+    if (n == fracLimbs + 1 && std::all_of(res, res + n, [](uint32_t limb) { return limb == 0; })) {
+        sign = 0;
+    }
+    return n;
+}
+template<int FracDigits>
+size_t BasicBigFloatArray<FracDigits>::fmaKernel(uint32_t *res, uint32_t *work, char &sign,
+                                                 const uint32_t *a, size_t an, char as, const uint32_t *b, size_t bn,
+                                                 char bs, const uint32_t *c, size_t cn, char cs) {
+    if (cn == fracLimbs + 1 && std::all_of(c, c + cn, [](uint32_t limb) { return limb == 0; })) {
+        cn = 0;
+    }
+    //The product has 2 * fracLimbs fractional limbs, c lines up with it fracLimbs limbs up
+    mult(work, a, an, b, bn);
+    size_t pn = an + bn;
+    while (pn > 1 && work[pn - 1] == 0) --pn;
+    char ps = as ^ bs;
+    const uint32_t *exact = work;
+    size_t n = pn;
+    if (cn && ps == cs) {
+        n = std::max(pn, fracLimbs + cn);
+        std::fill(work + pn, work + n + 1, 0);
+        work[n] = sum(work + fracLimbs, work + fracLimbs, n - fracLimbs, c, cn);
+        ++n;
+    } else if (cn && compare(work + fracLimbs, pn > fracLimbs ? pn - fracLimbs : 0, c, cn) >= 0) {
+        //The product is the larger one: at least c in its high limbs and never negative in its low ones.
+        //Limbs of c past the product are zero then
+        substract(work + fracLimbs, work + fracLimbs, pn - fracLimbs, c, std::min(cn, pn - fracLimbs));
+    } else if (cn) {
+        //c * base^fracLimbs - product, the product being the shorter one
+        std::fill(res, res + fracLimbs, 0);
+        std::copy(c, c + cn, res + fracLimbs);
+        n = fracLimbs + cn;
+        substract(res, res, n, work, pn);
+        exact = res;
+        ps = cs;
+    }
+    //Dropping the low limbs truncates toward zero, res may be exact itself
+    n = n > fracLimbs ? n - fracLimbs : 0;
+    std::copy(exact + fracLimbs, exact + fracLimbs + n, res);
+    for (; n < fracLimbs + 1; ++n) res[n] = 0;
+    n = trimmed(res, n);
+    sign = ps;
+    if (n == fracLimbs + 1 && std::all_of(res, res + n, [](uint32_t limb) { return limb == 0; })) {
+        sign = 0;
+    }
+    return n;
+}
+
+template<int FracDigits>
+template<class Partial, class Fn>
+void BasicBigFloatArray<FracDigits>::forTiles(size_t n, size_t elementLimbs, Partial &partial, Fn fn) {
+    if (n == 0) {
+        return;
+    }
+    size_t tile = std::max<size_t>(1, tileLimbs / elementLimbs);
+    size_t grain = n;
+    //Arrays worth less than one parallel multiplication stay on the calling thread, like a serial pool does
+    unsigned workers = TaskPool::instance().workers();
+    if (workers && n * elementLimbs >= parallelCutoff()) {
+        size_t chunks = 8 * (workers + 1);
+        grain = std::max(tile, (n + chunks - 1) / chunks);
+    }
+    forTilesRange(0, n, grain, tile, partial, fn);
+}
+template<int FracDigits>
+template<class Partial, class Fn>
+void BasicBigFloatArray<FracDigits>::forTilesRange(size_t begin, size_t end, size_t grain, size_t tile,
+                                                   Partial &partial, Fn &fn) {
+    if (end - begin <= grain) {
+        for (size_t i = begin; i < end; i += tile) {
+            fn(i, std::min(end, i + tile), partial);
+        }
+        return;
+    }
+    size_t mid = begin + (end - begin) / 2;
+    Partial left;
+    auto leftHalf = TaskPool::task([&] { forTilesRange(begin, mid, grain, tile, left, fn); });
+    TaskPool::Group group;
+    group.fork(leftHalf);
+    forTilesRange(mid, end, grain, tile, partial, fn);
+    group.join();
+    partial += left;
+}
+
+template<int FracDigits>
+void BasicBigFloatArray<FracDigits>::add(BasicBigFloatArray &res, const BasicBigFloatArray &a,
+                                         const BasicBigFloatArray &b) {
+    checkSizes(a.size(), b.size());
+    //Widening res first keeps operands that alias it consistent
+    res.reserveIntLimbs(std::max(a.maxIntLimbs(), b.maxIntLimbs()) + 1);
+    res.resize(a.size());
+    NoPartial none;
+    forTiles(a.size(), a.stride + b.stride + res.stride, none, [&](size_t begin, size_t end, NoPartial &) {
+        Scratch scratch;
+        uint32_t *out = scratch.alloc(res.stride + 1);
+        for (size_t i = begin; i < end; ++i) {
+            char sign;
+            size_t n = addKernel(out, sign, a.at(i), a.sizes[i], a.signs[i], b.at(i), b.sizes[i], b.signs[i]);
+            res.store(i, out, n, sign);
+        }
+    });
+}
+template<int FracDigits>
+void BasicBigFloatArray<FracDigits>::sub(BasicBigFloatArray &res, const BasicBigFloatArray &a,
+                                         const BasicBigFloatArray &b) {
+    checkSizes(a.size(), b.size());
+    res.reserveIntLimbs(std::max(a.maxIntLimbs(), b.maxIntLimbs()) + 1);
+    res.resize(a.size());
+    NoPartial none;
+    forTiles(a.size(), a.stride + b.stride + res.stride, none, [&](size_t begin, size_t end, NoPartial &) {
+        Scratch scratch;
+        uint32_t *out = scratch.alloc(res.stride + 1);
+        for (size_t i = begin; i < end; ++i) {
+            char sign;
+            size_t n = addKernel(out, sign, a.at(i), a.sizes[i], a.signs[i], b.at(i), b.sizes[i], 1 - b.signs[i]);
+            res.store(i, out, n, sign);
+        }
+    });
+}
+template<int FracDigits>
+void BasicBigFloatArray<FracDigits>::mul(BasicBigFloatArray &res, const BasicBigFloatArray &a,
+                                         const BasicBigFloatArray &b) {
+    checkSizes(a.size(), b.size());
+    res.reserveIntLimbs(a.maxIntLimbs() + b.maxIntLimbs());
+    res.resize(a.size());
+    NoPartial none;
+    forTiles(a.size(), a.stride + b.stride + res.stride, none, [&](size_t begin, size_t end, NoPartial &) {
+        Scratch scratch;
+        uint32_t *work = scratch.alloc(a.stride + b.stride + 1);
+        uint32_t *out = scratch.alloc(a.stride + b.stride + 1);
+        for (size_t i = begin; i < end; ++i) {
+            char sign;
+            size_t n = fmaKernel(out, work, sign, a.at(i), a.sizes[i], a.signs[i], b.at(i), b.sizes[i], b.signs[i],
+                                 nullptr, 0, 0);
+            res.store(i, out, n, sign);
+        }
+    });
+}
+template<int FracDigits>
+void BasicBigFloatArray<FracDigits>::fma(BasicBigFloatArray &res, const BasicBigFloatArray &a,
+                                         const BasicBigFloatArray &b, const BasicBigFloatArray &c) {
+    checkSizes(a.size(), b.size());
+    checkSizes(a.size(), c.size());
+    res.reserveIntLimbs(std::max(a.maxIntLimbs() + b.maxIntLimbs(), c.maxIntLimbs()) + 1);
+    res.resize(a.size());
+    NoPartial none;
+    forTiles(a.size(), a.stride + b.stride + c.stride + res.stride, none, [&](size_t begin, size_t end, NoPartial &) {
+        Scratch scratch;
+        size_t widest = std::max(a.stride + b.stride, fracLimbs + c.stride) + 1;
+        uint32_t *work = scratch.alloc(widest);
+        uint32_t *out = scratch.alloc(widest);
+        for (size_t i = begin; i < end; ++i) {
+            char sign;
+            size_t n = fmaKernel(out, work, sign, a.at(i), a.sizes[i], a.signs[i], b.at(i), b.sizes[i], b.signs[i],
+                                 c.at(i), c.sizes[i], c.signs[i]);
+            res.store(i, out, n, sign);
+        }
+    });
+}
+template<int FracDigits>
+void BasicBigFloatArray<FracDigits>::axpy(BasicBigFloatArray &y, const Number &alpha, const BasicBigFloatArray &x) {
+    checkSizes(y.size(), x.size());
+    BigFloatView a = alpha.view();
+    y.reserveIntLimbs(std::max(a.size() - fracLimbs + x.maxIntLimbs(), y.maxIntLimbs()) + 1);
+    NoPartial none;
+    forTiles(x.size(), x.stride + 2 * y.stride, none, [&](size_t begin, size_t end, NoPartial &) {
+        Scratch scratch;
+        size_t widest = std::max(a.size() + x.stride, fracLimbs + y.stride) + 1;
+        uint32_t *work = scratch.alloc(widest);
+        uint32_t *out = scratch.alloc(widest);
+        for (size_t i = begin; i < end; ++i) {
+            char sign;
+            size_t n = fmaKernel(out, work, sign, a.limbs(), a.size(), a.sign(), x.at(i), x.sizes[i], x.signs[i],
+                                 y.at(i), y.sizes[i], y.signs[i]);
+            y.store(i, out, n, sign);
+        }
+    });
+}
+template<int FracDigits>
+BasicBigFloat<FracDigits> BasicBigFloatArray<FracDigits>::dot(const BasicBigFloatArray &a,
+                                                              const BasicBigFloatArray &b) {
+    checkSizes(a.size(), b.size());
+    WideAccumulator sum;
+    forTiles(a.size(), a.stride + b.stride, sum, [&](size_t begin, size_t end, WideAccumulator &partial) {
+        Scratch scratch;
+        uint32_t *product = scratch.alloc(a.stride + b.stride);
+        for (size_t i = begin; i < end; ++i) {
+            mult(product, a.at(i), a.sizes[i], b.at(i), b.sizes[i]);
+            partial.add(product, a.sizes[i] + b.sizes[i], a.signs[i] ^ b.signs[i]);
+        }
+    });
+    return Number(sum.result());
+}
@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "BigFloatTable.h"
+
+//Views point straight into the file, so its words have to be in host order
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "BigFloatTable needs a little-endian host");
+
+namespace {
+    //"BFTB" read as a little-endian word
+    const uint32_t tableMagic = 0x42544642;
+    const uint32_t tableVersion = 1;
+    const size_t headerBytes = 8 * sizeof(uint32_t);
+    //Records are buffered and written in blocks of this many words
+    const size_t flushWords = 1 << 18;
+
+    void writeAt(int fd, const void *data, size_t n, uint64_t at) {
+        const char *p = static_cast<const char *>(data);
+        while (n > 0) {
+            ssize_t written = ::pwrite(fd, p, n, static_cast<off_t>(at));
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                throw std::system_error(errno, std::generic_category(), "BigFloatTable: write failed");
+            }
+            p += written;
+            n -= written;
+            at += written;
+        }
+    }
+    [[noreturn]] void corrupt() {
+        throw std::runtime_error("BigFloatTable: corrupt record");
+    }
+}
+
+BigFloatTableWriter::BigFloatTableWriter(const std::string &path) : offset(headerBytes) {
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "BigFloatTable: cannot create " + path);
+    }
+}
+BigFloatTableWriter::~BigFloatTableWriter() {
+    try {
+        finish();
+    } catch (...) {
+    }
+}
+void BigFloatTableWriter::add(const BigFloatView &value) {
+    if (fracLimbs < 0) {
+        fracLimbs = value.fracLimbs();
+    } else if (value.fracLimbs() != fracLimbs) {
+        throw std::invalid_argument("BigFloatTable: values of different precisions");
+    }
+    if (value.size() > UINT32_MAX) {
+        throw std::length_error("BigFloatTable: value too long");
+    }
+    offsets.push_back(offset);
+    const uint32_t record[2] = {static_cast<uint32_t>(value.sign()), static_cast<uint32_t>(value.size())};
+    put(record, 2);
+    put(value.limbs(), value.size());
+}
+void BigFloatTableWriter::put(const uint32_t *words, size_t n) {
+    buffer.insert(buffer.end(), words, words + n);
+    offset += n * sizeof(uint32_t);
+    if (buffer.size() >= flushWords) {
+        flush();
+    }
+}
+void BigFloatTableWriter::flush() {
+    size_t bytes = buffer.size() * sizeof(uint32_t);
+    writeAt(fd, buffer.data(), bytes, offset - bytes);
+    buffer.clear();
+}
+void BigFloatTableWriter::finish() {
+    if (fd < 0) {
+        return;
+    }
+    try {
+        //The index of 64-bit words starts 8-byte aligned
+        if (offset % 8) {
+            const uint32_t pad = 0;
+            put(&pad, 1);
+        }
+        uint64_t indexOffset = offset;
+        put(reinterpret_cast<const uint32_t *>(offsets.data()), 2 * offsets.size());
+        flush();
+        uint64_t n = offsets.size();
+        const uint32_t header[8] = {tableMagic, tableVersion, static_cast<uint32_t>(std::max(fracLimbs, 0)), 0,
+                                    static_cast<uint32_t>(n), static_cast<uint32_t>(n >> 32),
+                                    static_cast<uint32_t>(indexOffset), static_cast<uint32_t>(indexOffset >> 32)};
+        writeAt(fd, header, sizeof(header), 0);
+    } catch (...) {
+        ::close(fd);
+        fd = -1;
+        throw;
+    }
+    int file = fd;
+    fd = -1;
+    if (::close(file) < 0) {
+        throw std::system_error(errno, std::generic_category(), "BigFloatTable: close failed");
+    }
+}
+
+BigFloatTable::BigFloatTable(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "BigFloatTable: cannot open " + path);
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) < 0) {
+        int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "BigFloatTable: cannot stat " + path);
+    }
+    mappedBytes = static_cast<size_t>(st.st_size);
+    if (mappedBytes < headerBytes) {
+        ::close(fd);
+        throw std::runtime_error("BigFloatTable: " + path + " is not a table");
+    }
+    void *p = ::mmap(nullptr, mappedBytes, PROT_READ, MAP_SHARED, fd, 0);
+    int error = errno;
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        throw std::system_error(error, std::generic_category(), "BigFloatTable: cannot map " + path);
+    }
+    mapping = static_cast<const unsigned char *>(p);
+    uint32_t header[8];
+    std::memcpy(header, mapping, sizeof(header));
+    uint64_t n = header[4] | static_cast<uint64_t>(header[5]) << 32;
+    indexOffset = header[6] | static_cast<uint64_t>(header[7]) << 32;
+    count = static_cast<size_t>(n);
+    fraction = static_cast<int>(header[2]);
+    bool valid = header[0] == tableMagic && header[1] == tableVersion && header[2] <= INT32_MAX && indexOffset % 8 == 0 &&
+                 indexOffset >= headerBytes && indexOffset <= mappedBytes && n <= (mappedBytes - indexOffset) / 8;
+    if (!valid) {
+        ::munmap(p, mappedBytes);
+        throw std::runtime_error("BigFloatTable: " + path + " is not a table of version " + std::to_string(tableVersion));
+    }
+}
+BigFloatTable::~BigFloatTable() {
+    if (mapping) {
+        ::munmap(const_cast<unsigned char *>(mapping), mappedBytes);
+    }
+}
+BigFloatTable::BigFloatTable(BigFloatTable &&other) noexcept
+    : mapping(other.mapping), mappedBytes(other.mappedBytes), count(other.count), fraction(other.fraction),
+      indexOffset(other.indexOffset) {
+    other.mapping = nullptr;
+    other.count = 0;
+}
+BigFloatView BigFloatTable::operator[](size_t i) const {
+    if (i >= count) {
+        throw std::out_of_range("BigFloatTable: value " + std::to_string(i) + " of " + std::to_string(count));
+    }
+    uint64_t at;
+    std::memcpy(&at, mapping + indexOffset + i * sizeof(uint64_t), sizeof(at));
+    if (at % sizeof(uint32_t) || at < headerBytes || at + 2 * sizeof(uint32_t) > indexOffset) {
+        corrupt();
+    }
+    uint32_t record[2];
+    std::memcpy(record, mapping + at, sizeof(record));
+    uint64_t room = (indexOffset - at) / sizeof(uint32_t) - 2;
+    if (record[0] > 1 || record[1] <= static_cast<uint32_t>(fraction) || record[1] > room) {
+        corrupt();
+    }
+    auto limbs = reinterpret_cast<const uint32_t *>(mapping + at + 2 * sizeof(uint32_t));
+    return BigFloatView(static_cast<char>(record[0]), limbs, record[1], fraction);
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "BigFloat.h"
+
+//File of many values that BigFloatTable maps into memory and reads without parsing or copying.
+//Layout, 32-bit little-endian words: a header of "BFTB", version, fracLimbs, a reserved word, the value count and
+//the byte offset of the index as two words each (low first); then one record per value: sign, limb count and the
+//limbs; then the index, the byte offset of every record as a 64-bit word
+class BigFloatTableWriter : public BigFloatBase {
+public:
+    //Throws std::system_error when the file cannot be created
+    explicit BigFloatTableWriter(const std::string &path);
+    //Finishes the file if finish() was not called, errors are lost then
+    ~BigFloatTableWriter();
+    BigFloatTableWriter(const BigFloatTableWriter &) = delete;
+    BigFloatTableWriter &operator=(const BigFloatTableWriter &) = delete;
+    //Every value of a table has the precision of the first one, others throw std::invalid_argument
+    void add(const BigFloatView &value);
+    //Writes the index and the header and closes the file. Throws std::system_error on write errors
+    void finish();
+
+private:
+    void flush();
+    void put(const uint32_t *words, size_t n);
+    int fd;
+    int fracLimbs = -1;
+    uint64_t offset;
+    std::vector<uint64_t> offsets;
+    std::vector<uint32_t> buffer;
+};
+
+//Read-only view of a file written by BigFloatTableWriter. The file is mapped, so opening it costs the same for
+//any number of values and operator[] hands out views straight into the mapping
+class BigFloatTable : public BigFloatBase {
+public:
+    //Throws std::system_error when the file cannot be mapped and std::runtime_error when it is not a table.
+    //The records themselves are trusted, only their bounds are checked
+    explicit BigFloatTable(const std::string &path);
+    ~BigFloatTable();
+    BigFloatTable(BigFloatTable &&other) noexcept;
+    BigFloatTable(const BigFloatTable &) = delete;
+    BigFloatTable &operator=(const BigFloatTable &) = delete;
+    BigFloatTable &operator=(BigFloatTable &&) = delete;
+
+    [[nodiscard]] size_t size() const { return count; }
+    [[nodiscard]] int fracLimbs() const { return fraction; }
+    //Valid while the table is open. Throws std::out_of_range past the end
+    BigFloatView operator[](size_t i) const;
+
+private:
+    const unsigned char *mapping = nullptr;
+    size_t mappedBytes = 0;
+    size_t count = 0;
+    int fraction = 0;
+    uint64_t indexOffset = 0;
+};
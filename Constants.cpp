@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include "Constants.h"
+#include "PiEngine.h"
+
+namespace {
+    //Cached limbs are shared with readers, which truncate them after the lock is released
+    struct Entry {
+        std::mutex m;
+        std::condition_variable ready;
+        std::shared_ptr<const std::vector<uint32_t>> limbs;
+        size_t fracLimbs = 0;
+        bool computing = false;
+    };
+    Entry entries[4];
+
+    Entry &entryOf(BigFloatBase::Constant c) {
+        return entries[static_cast<size_t>(c)];
+    }
+    //Caller holds the lock. Values no longer than the cached one are dropped
+    void publish(Entry &entry, const std::vector<uint32_t> &limbs, size_t fracLimbs) {
+        if (!entry.limbs || fracLimbs > entry.fracLimbs) {
+            entry.limbs = std::make_shared<const std::vector<uint32_t>>(limbs);
+            entry.fracLimbs = fracLimbs;
+        }
+    }
+}
+
+std::vector<uint32_t> Constants::compute(Constant c, size_t fracLimbs) {
+    switch (c) {
+        case Constant::Pi:
+            return PiEngine::fixedPoint(fracLimbs);
+        case Constant::E:
+            return PiEngine::eFixedPoint(fracLimbs);
+        case Constant::Ln2:
+            return PiEngine::ln2FixedPoint(fracLimbs);
+        case Constant::Sqrt2: {
+            LimbVector two(fracLimbs + 1);
+            two.back() = 2;
+            LimbVector root = sqrtFixedPoint(two, static_cast<int>(fracLimbs));
+            return std::vector<uint32_t>(root.begin(), root.end());
+        }
+    }
+    throw std::invalid_argument("Unknown constant");
+}
+
+std::vector<uint32_t> Constants::fixedPoint(Constant c, size_t fracLimbs) {
+    Entry &entry = entryOf(c);
+    std::unique_lock<std::mutex> lock(entry.m);
+    auto cached = [&] { return entry.limbs && entry.fracLimbs >= fracLimbs; };
+    entry.ready.wait(lock, [&] { return cached() || !entry.computing; });
+    if (cached()) {
+        std::shared_ptr<const std::vector<uint32_t>> limbs = entry.limbs;
+        size_t drop = entry.fracLimbs - fracLimbs;
+        lock.unlock();
+        return std::vector<uint32_t>(limbs->begin() + drop, limbs->end());
+    }
+    entry.computing = true;
+    lock.unlock();
+    std::vector<uint32_t> limbs;
+    try {
+        limbs = compute(c, fracLimbs);
+    } catch (...) {
+        lock.lock();
+        entry.computing = false;
+        lock.unlock();
+        entry.ready.notify_all();
+        throw;
+    }
+    lock.lock();
+    publish(entry, limbs, fracLimbs);
+    entry.computing = false;
+    lock.unlock();
+    entry.ready.notify_all();
+    return limbs;
+}
+size_t Constants::cachedLimbs(Constant c) {
+    Entry &entry = entryOf(c);
+    std::lock_guard<std::mutex> lock(entry.m);
+    return entry.fracLimbs;
+}
+void Constants::preload(Constant c, const std::string &path) {
+    std::ifstream in(path);
+    std::string text;
+    if (!(in >> text)) {
+        throw std::runtime_error("Cannot read " + path);
+    }
+    size_t dot = text.find('.');
+    bool digitsOnly = std::all_of(text.begin(), text.end(), [](char ch) { return ch == '.' || (ch >= '0' && ch <= '9'); });
+    if (dot == std::string::npos || dot == 0 || !digitsOnly || text.find('.', dot + 1) != std::string::npos) {
+        throw std::runtime_error(path + " does not hold a decimal number");
+    }
+    size_t fracLimbs = (text.size() - dot - 1) / digitsPerLimb;
+    size_t intLimbs = parsedIntLimbs(text.c_str());
+    std::vector<uint32_t> limbs(fracLimbs + intLimbs);
+    char sign;
+    parse(text.c_str(), sign, limbs.data(), intLimbs, static_cast<int>(fracLimbs));
+    Entry &entry = entryOf(c);
+    {
+        std::lock_guard<std::mutex> lock(entry.m);
+        publish(entry, limbs, fracLimbs);
+    }
+    entry.ready.notify_all();
+}
+
+BigFloatBase::LimbVector BigFloatBase::constantFixedPoint(Constant c, int fracLimbs) {
+    std::vector<uint32_t> limbs = Constants::fixedPoint(c, fracLimbs);
+    return LimbVector(limbs.begin(), limbs.end());
+}
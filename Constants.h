@@ -0,0 +1,41 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "BigFloat.h"
+
+//Process-wide cache of pi, e, ln 2 and sqrt 2. A constant is computed once at the highest precision asked for so far
+//and lower precisions are truncations of it. Threads asking for a constant that is being computed wait for that
+//computation instead of repeating it; the lock of a constant is only held to look its value up or publish a new one
+class Constants : public BigFloatBase {
+public:
+    //floor(c * base^fracLimbs) as little-endian limbs, fraction first like BasicBigFloat
+    static std::vector<uint32_t> fixedPoint(Constant c, size_t fracLimbs);
+    template<int FracDigits>
+    static BasicBigFloat<FracDigits> value(Constant c);
+    template<int FracDigits>
+    static BasicBigFloat<FracDigits> pi() { return value<FracDigits>(Constant::Pi); }
+    template<int FracDigits>
+    static BasicBigFloat<FracDigits> e() { return value<FracDigits>(Constant::E); }
+    template<int FracDigits>
+    static BasicBigFloat<FracDigits> ln2() { return value<FracDigits>(Constant::Ln2); }
+    template<int FracDigits>
+    static BasicBigFloat<FracDigits> sqrt2() { return value<FracDigits>(Constant::Sqrt2); }
+    //Fractional limbs of c the cache holds, 0 before it is first computed
+    static size_t cachedLimbs(Constant c);
+    //Fills the cache from a file with the decimal expansion of c, such as "3.14159...", so services start warm.
+    //The digits are trusted as they are; the ones past the last whole limb are dropped and a file shorter than the
+    //cached value changes nothing. Throws std::runtime_error when the file cannot be read or holds no such number
+    static void preload(Constant c, const std::string &path);
+
+private:
+    static std::vector<uint32_t> compute(Constant c, size_t fracLimbs);
+};
+
+template<int FracDigits>
+BasicBigFloat<FracDigits> Constants::value(Constant c) {
+    constexpr size_t fracLimbs = (FracDigits + digitsPerLimb - 1) / digitsPerLimb;
+    std::vector<uint32_t> limbs = fixedPoint(c, fracLimbs);
+    std::vector<uint32_t> intPart(limbs.begin() + fracLimbs, limbs.end());
+    limbs.resize(fracLimbs);
+    return BasicBigFloat<FracDigits>(intPart, limbs, 0);
+}
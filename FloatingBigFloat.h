@@ -0,0 +1,344 @@
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "BigFloat.h"
+
+//Floating point number of at least Digits significant decimal digits: a mantissa of a fixed number of limbs with a
+//nonzero top limb and a 64-bit exponent in limbs, value = mantissa * base^exponent. Unlike BasicBigFloat, an operation
+//costs the same for 16^1000 and 10^-1000 as for 1: only the mantissa limbs are ever walked.
+//Every result is rounded to the nearest mantissa, ties to the even last limb; the exponent is in base 10^9 like the
+//limbs, so decimal values such as 0.1 are exact whenever they fit the mantissa.
+//Exponents past maxExponent limbs either way throw std::overflow_error
+template<int Digits>
+class BasicFloatingBigFloat : public BigFloatBase {
+    template<int> friend class BasicFloatingBigFloat;
+public:
+    //One limb more than Digits needs, the top limb may hold a single digit
+    static constexpr size_t mantissaLimbs = (Digits + digitsPerLimb - 1) / digitsPerLimb + 1;
+    static constexpr int64_t maxExponent = int64_t(1) << 59;
+
+private:
+    static constexpr bool inlineMantissa = mantissaLimbs <= maxInlineFracLimbs + 2;
+
+    //mantissaLimbs limbs, none for zero
+    LimbStorage<inlineMantissa ? mantissaLimbs : 0> mantissa;
+    int64_t exponent;
+    char sign;
+
+    BasicFloatingBigFloat() : exponent(0), sign(0) {}
+    void setZero();
+    //Sets res to limbs * base^exp rounded to the mantissa, sticky tells that nonzero limbs below the given ones were cut.
+    //limbs may have leading zeroes and must not point into res
+    static void assign(BasicFloatingBigFloat &res, const uint32_t *limbs, size_t size, int64_t exp, char sign_, bool sticky);
+    static int compareMagnitudes(const BasicFloatingBigFloat &a, const BasicFloatingBigFloat &b);
+    static int compare(const BasicFloatingBigFloat &a, const BasicFloatingBigFloat &b);
+    //Operations store into res, which may be one of the operands
+    static void add(BasicFloatingBigFloat &res, const BasicFloatingBigFloat &a, const BasicFloatingBigFloat &b, char bSign);
+    static void mul(BasicFloatingBigFloat &res, const BasicFloatingBigFloat &a, const BasicFloatingBigFloat &b);
+    static void div(BasicFloatingBigFloat &res, const BasicFloatingBigFloat &x, const BasicFloatingBigFloat &y);
+
+public:
+    explicit BasicFloatingBigFloat(int x);
+    //Decimal text with an optional decimal exponent, such as "-1.25e-3000"
+    explicit BasicFloatingBigFloat(const char *x);
+    //Rounds the exact value of a fixed point number or a view
+    explicit BasicFloatingBigFloat(const BigFloatView &x);
+    template<int FracDigits>
+    explicit BasicFloatingBigFloat(const BasicBigFloat<FracDigits> &x) : BasicFloatingBigFloat(x.view()) {}
+    //Changes precision, rounding like every operation does
+    template<int OtherDigits>
+    explicit BasicFloatingBigFloat(const BasicFloatingBigFloat<OtherDigits> &other);
+    //Fixed point value truncated towards zero. Its integer part takes as many limbs as the magnitude asks for
+    template<int FracDigits>
+    [[nodiscard]] BasicBigFloat<FracDigits> toFixed() const;
+
+    [[nodiscard]] bool isZero() const { return mantissa.size() == 0; }
+    //Decimal exponent of the leading digit, |x| is in [10^m, 10^(m + 1)). INT64_MIN for zero
+    [[nodiscard]] int64_t magnitude() const;
+    //Scientific notation with up to `digits` significant digits, truncated: "-1.25e-3000". "0" for zero
+    [[nodiscard]] std::string toString(size_t digits) const;
+
+    BasicFloatingBigFloat& operator += (const BasicFloatingBigFloat &other) { add(*this, *this, other, other.sign); return *this; }
+    BasicFloatingBigFloat& operator -= (const BasicFloatingBigFloat &other) { add(*this, *this, other, other.isZero() ? 0 : 1 - other.sign); return *this; }
+    BasicFloatingBigFloat& operator *= (const BasicFloatingBigFloat &other) { mul(*this, *this, other); return *this; }
+    BasicFloatingBigFloat& operator /= (const BasicFloatingBigFloat &other) { div(*this, *this, other); return *this; }
+    friend BasicFloatingBigFloat operator+(BasicFloatingBigFloat a, const BasicFloatingBigFloat &b) { return std::move(a += b); }
+    friend BasicFloatingBigFloat operator-(BasicFloatingBigFloat a, const BasicFloatingBigFloat &b) { return std::move(a -= b); }
+    friend BasicFloatingBigFloat operator*(BasicFloatingBigFloat a, const BasicFloatingBigFloat &b) { return std::move(a *= b); }
+    friend BasicFloatingBigFloat operator/(BasicFloatingBigFloat a, const BasicFloatingBigFloat &b) { return std::move(a /= b); }
+    BasicFloatingBigFloat operator -() const {
+        BasicFloatingBigFloat res = *this;
+        res.sign = isZero() ? 0 : 1 - sign;
+        return res;
+    }
+    friend BasicFloatingBigFloat abs(BasicFloatingBigFloat x) {
+        x.sign = 0;
+        return x;
+    }
+    bool operator < (const BasicFloatingBigFloat &other) const { return compare(*this, other) < 0; }
+    bool operator <= (const BasicFloatingBigFloat &other) const { return compare(*this, other) <= 0; }
+    bool operator > (const BasicFloatingBigFloat &other) const { return compare(*this, other) > 0; }
+    bool operator >= (const BasicFloatingBigFloat &other) const { return compare(*this, other) >= 0; }
+    bool operator == (const BasicFloatingBigFloat &other) const { return compare(*this, other) == 0; }
+    bool operator != (const BasicFloatingBigFloat &other) const { return compare(*this, other) != 0; }
+    friend std::ostream& operator << (std::ostream &out, const BasicFloatingBigFloat &x) {
+        return out << x.toString(mantissaLimbs * digitsPerLimb);
+    }
+};
+
+using FloatingBigFloat = BasicFloatingBigFloat<128>;
+
+template<int Digits>
+void BasicFloatingBigFloat<Digits>::setZero() {
+    mantissa.resize(0);
+    exponent = 0;
+    sign = 0;
+}
+template<int Digits>
+void BasicFloatingBigFloat<Digits>::assign(BasicFloatingBigFloat &res, const uint32_t *limbs, size_t size, int64_t exp, char sign_, bool sticky) {
+    while (size > 0 && limbs[size - 1] == 0) {
+        --size;
+    }
+    if (size == 0) {
+        res.setZero();
+        return;
+    }
+    constexpr size_t n = mantissaLimbs;
+    res.mantissa.resize(n);
+    uint32_t *m = res.mantissa.data();
+    if (size <= n) {
+        std::fill(m, m + (n - size), 0);
+        std::copy(limbs, limbs + size, m + (n - size));
+        exp -= static_cast<int64_t>(n - size);
+    } else {
+        //The first dropped limb against half a unit of the last kept one decides, the limbs below it break ties
+        size_t drop = size - n;
+        uint32_t guard = limbs[drop - 1];
+        bool rest = sticky || std::any_of(limbs, limbs + drop - 1, [](uint32_t limb) { return limb != 0; });
+        bool up = guard > base / 2 || (guard == base / 2 && (rest || limbs[drop] % 2 == 1));
+        std::copy(limbs + drop, limbs + size, m);
+        exp += static_cast<int64_t>(drop);
+        if (up) {
+            size_t i = 0;
+            while (i < n && m[i] == base - 1) {
+                m[i++] = 0;
+            }
+            if (i < n) {
+                ++m[i];
+            } else {
+                m[n - 1] = 1;
+                ++exp;
+            }
+        }
+    }
+    if (exp > maxExponent || exp < -maxExponent) {
+        res.setZero();
+        throw std::overflow_error("BigFloat: exponent out of range");
+    }
+    res.exponent = exp;
+    res.sign = sign_;
+}
+template<int Digits>
+BasicFloatingBigFloat<Digits>::BasicFloatingBigFloat(int x) : BasicFloatingBigFloat() {
+    uint64_t ux = x < 0 ? 0 - static_cast<uint64_t>(x) : static_cast<uint64_t>(x);
+    const uint32_t limbs[2] = {static_cast<uint32_t>(ux % base), static_cast<uint32_t>(ux / base)};
+    assign(*this, limbs, 2, 0, x < 0, false);
+}
+template<int Digits>
+BasicFloatingBigFloat<Digits>::BasicFloatingBigFloat(const char *x) : BasicFloatingBigFloat() {
+    const char *s = x;
+    char sign_ = 0;
+    if (*s == '-') {
+        sign_ = 1;
+        ++s;
+    }
+    //value = digits * 10^decimalExp, the digits are grouped into limbs once the exponent is a multiple of a limb
+    std::string digits;
+    int64_t decimalExp = 0;
+    bool fraction = false;
+    for (; *s && *s != 'e' && *s != 'E'; ++s) {
+        if (*s == '.') {
+            fraction = true;
+        } else {
+            digits.push_back(*s);
+            decimalExp -= fraction;
+        }
+    }
+    if (*s) {
+        decimalExp += std::strtoll(s + 1, nullptr, 10);
+    }
+    int64_t exp = decimalExp / digitsPerLimb, shift = decimalExp % digitsPerLimb;
+    if (shift < 0) {
+        shift += digitsPerLimb;
+        --exp;
+    }
+    digits.append(shift, '0');
+    LimbVector limbs((digits.size() + digitsPerLimb - 1) / digitsPerLimb, 0);
+    size_t limb = 0;
+    for (size_t end = digits.size(); end > 0; ++limb) {
+        size_t begin = end > digitsPerLimb ? end - digitsPerLimb : 0;
+        for (size_t i = begin; i < end; ++i) limbs[limb] = limbs[limb] * 10 + (digits[i] - '0');
+        end = begin;
+    }
+    assign(*this, limbs.data(), limbs.size(), exp, sign_, false);
+}
+template<int Digits>
+BasicFloatingBigFloat<Digits>::BasicFloatingBigFloat(const BigFloatView &x) : BasicFloatingBigFloat() {
+    assign(*this, x.limbs(), x.size(), -x.fracLimbs(), x.sign(), false);
+}
+template<int Digits>
+template<int OtherDigits>
+BasicFloatingBigFloat<Digits>::BasicFloatingBigFloat(const BasicFloatingBigFloat<OtherDigits> &other) : BasicFloatingBigFloat() {
+    assign(*this, other.mantissa.data(), other.mantissa.size(), other.exponent, other.sign, false);
+}
+template<int Digits>
+template<int FracDigits>
+BasicBigFloat<FracDigits> BasicFloatingBigFloat<Digits>::toFixed() const {
+    constexpr int64_t fracLimbs = (FracDigits + digitsPerLimb - 1) / digitsPerLimb;
+    std::vector<uint32_t> intPart, fracPart(fracLimbs, 0);
+    int64_t top = exponent + static_cast<int64_t>(mantissa.size());
+    if (top > 0) {
+        intPart.resize(top, 0);
+    }
+    bool kept = false;
+    //Limb i of the mantissa has the weight base^(exponent + i), fractional ones past fracLimbs are cut
+    for (size_t i = 0; i < mantissa.size(); ++i) {
+        int64_t position = exponent + static_cast<int64_t>(i);
+        if (position >= 0) {
+            intPart[position] = mantissa[i];
+        } else if (position >= -fracLimbs) {
+            fracPart[fracLimbs + position] = mantissa[i];
+        } else {
+            continue;
+        }
+        kept |= mantissa[i] != 0;
+    }
+    return BasicBigFloat<FracDigits>(intPart, fracPart, kept ? sign : 0);
+}
+template<int Digits>
+int64_t BasicFloatingBigFloat<Digits>::magnitude() const {
+    if (isZero()) {
+        return INT64_MIN;
+    }
+    int64_t m = (exponent + static_cast<int64_t>(mantissaLimbs) - 1) * digitsPerLimb;
+    for (uint32_t limb = mantissa.back(); limb >= 10; limb /= 10) {
+        ++m;
+    }
+    return m;
+}
+template<int Digits>
+std::string BasicFloatingBigFloat<Digits>::toString(size_t digits) const {
+    if (isZero()) {
+        return "0";
+    }
+    std::string text = std::to_string(mantissa.back());
+    for (size_t i = mantissaLimbs - 1; i-- > 0;) {
+        std::string limb = std::to_string(mantissa[i]);
+        text.append(digitsPerLimb - limb.size(), '0').append(limb);
+    }
+    text.resize(std::clamp<size_t>(digits, 1, text.size()));
+    while (text.size() > 1 && text.back() == '0') {
+        text.pop_back();
+    }
+    if (text.size() > 1) {
+        text.insert(1, ".");
+    }
+    return (sign ? "-" : "") + text + "e" + std::to_string(magnitude());
+}
+template<int Digits>
+int BasicFloatingBigFloat<Digits>::compareMagnitudes(const BasicFloatingBigFloat &a, const BasicFloatingBigFloat &b) {
+    if (a.exponent != b.exponent) {
+        return a.exponent < b.exponent ? -1 : 1;
+    }
+    return BigFloatBase::compare(a.mantissa.data(), mantissaLimbs, b.mantissa.data(), mantissaLimbs);
+}
+template<int Digits>
+int BasicFloatingBigFloat<Digits>::compare(const BasicFloatingBigFloat &a, const BasicFloatingBigFloat &b) {
+    if (a.isZero() || b.isZero()) {
+        int signA = a.isZero() ? 0 : a.sign ? -1 : 1, signB = b.isZero() ? 0 : b.sign ? -1 : 1;
+        return signA < signB ? -1 : signA > signB;
+    }
+    if (a.sign != b.sign) {
+        return a.sign ? -1 : 1;
+    }
+    int c = compareMagnitudes(a, b);
+    return a.sign ? -c : c;
+}
+template<int Digits>
+void BasicFloatingBigFloat<Digits>::add(BasicFloatingBigFloat &res, const BasicFloatingBigFloat &a, const BasicFloatingBigFloat &b, char bSign) {
+    if (b.isZero()) {
+        res = a;
+        return;
+    }
+    if (a.isZero()) {
+        res = b;
+        res.sign = bSign;
+        return;
+    }
+    const BasicFloatingBigFloat *hi = &a, *lo = &b;
+    char hiSign = a.sign, loSign = bSign;
+    if (compareMagnitudes(a, b) < 0) {
+        std::swap(hi, lo);
+        std::swap(hiSign, loSign);
+    }
+    //A mantissa more than a limb below the last one of the other cannot move it by half a unit
+    constexpr size_t n = mantissaLimbs;
+    uint64_t gap = hi->exponent - lo->exponent;
+    if (gap > n + 1) {
+        if (&res != hi) {
+            res = *hi;
+        }
+        res.sign = hiSign;
+        return;
+    }
+    //Both mantissas aligned on the lower exponent, the sum is exact before rounding
+    Scratch scratch;
+    size_t size = n + gap + 1;
+    uint32_t *limbs = scratch.alloc(size);
+    std::fill(limbs, limbs + gap, 0);
+    std::copy(hi->mantissa.begin(), hi->mantissa.end(), limbs + gap);
+    if (hiSign == loSign) {
+        limbs[size - 1] = sum(limbs, limbs, size - 1, lo->mantissa.data(), n);
+    } else {
+        limbs[size - 1] = 0;
+        substract(limbs, limbs, size - 1, lo->mantissa.data(), n);
+    }
+    assign(res, limbs, size, lo->exponent, hiSign, false);
+}
+template<int Digits>
+void BasicFloatingBigFloat<Digits>::mul(BasicFloatingBigFloat &res, const BasicFloatingBigFloat &a, const BasicFloatingBigFloat &b) {
+    if (a.isZero() || b.isZero()) {
+        res.setZero();
+        return;
+    }
+    constexpr size_t n = mantissaLimbs;
+    Scratch scratch;
+    uint32_t *limbs = scratch.alloc(2 * n);
+    mult(limbs, a.mantissa.data(), n, b.mantissa.data(), n);
+    assign(res, limbs, 2 * n, a.exponent + b.exponent, a.sign ^ b.sign, false);
+}
+template<int Digits>
+void BasicFloatingBigFloat<Digits>::div(BasicFloatingBigFloat &res, const BasicFloatingBigFloat &x, const BasicFloatingBigFloat &y) {
+    if (y.isZero()) {
+        throw std::runtime_error("Division by zero");
+    }
+    if (x.isZero()) {
+        res.setZero();
+        return;
+    }
+    //Shifting x by n + 1 limbs leaves at least one limb of the quotient past the mantissa to round on
+    constexpr size_t n = mantissaLimbs;
+    LimbVector num(2 * n + 1, 0), den(y.mantissa.begin(), y.mantissa.end());
+    std::copy(x.mantissa.begin(), x.mantissa.end(), num.begin() + n + 1);
+    LimbVector q = divide(num, den);
+    //Only an exact half in the cut limbs needs the remainder, to tell a tie from a value above it
+    size_t drop = q.size() - n;
+    bool sticky = false;
+    if (q[drop - 1] == base / 2 && std::all_of(q.begin(), q.begin() + drop - 1, [](uint32_t limb) { return limb == 0; })) {
+        LimbVector back = mulLimbs(q, den);
+        sticky = BigFloatBase::compare(back.data(), back.size(), num.data(), num.size()) != 0;
+    }
+    assign(res, q.data(), q.size(), x.exponent - y.exponent - static_cast<int64_t>(n + 1), x.sign ^ y.sign, sticky);
+}
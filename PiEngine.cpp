@@ -0,0 +1,185 @@
+#include <cmath>
+#include "PiEngine.h"
+#include "TaskPool.h"
+
+namespace {
+    //Ranges of at least this many terms offer their left half to the task pool
+    const uint64_t parallelTerms = 32;
+    //Limbs computed past the requested ones, they absorb the truncation of the series and of the square root
+    const size_t guardLimbs = 2;
+    //Splits [a, b) and evaluates both halves, the left one possibly on another worker
+    template<class Split, class Fn>
+    void splitRange(uint64_t a, uint64_t b, Split &left, Split &right, Fn fn) {
+        uint64_t m = (a + b) / 2;
+        auto leftHalf = TaskPool::task([&] { left = fn(a, m); });
+        if (b - a >= parallelTerms) {
+            //leftHalf refers to this frame, the group joins it before an error from the right half leaves
+            TaskPool::Group group;
+            group.fork(leftHalf);
+            right = fn(m, b);
+            group.join();
+        } else {
+            leftHalf.run();
+            right = fn(m, b);
+        }
+    }
+}
+
+PiEngine::Integer PiEngine::mul(const Integer &x, const Integer &y) {
+    return {mulLimbs(x.limbs, y.limbs), x.negative != y.negative};
+}
+PiEngine::Integer PiEngine::add(const Integer &x, const Integer &y) {
+    if (x.negative == y.negative) {
+        return {sum(x.limbs, y.limbs), x.negative};
+    }
+    bool less = compare(x.limbs, y.limbs) < 0;
+    Integer res{substract(x.limbs, y.limbs), less ? y.negative : x.negative};
+    trim(res.limbs);
+    return res;
+}
+BigFloatBase::LimbVector PiEngine::fromUint64(uint64_t x) {
+    LimbVector res;
+    do {
+        res.push_back(x % base);
+        x /= base;
+    } while (x);
+    return res;
+}
+BigFloatBase::LimbVector PiEngine::mulByTerm(const LimbVector &x, uint64_t y) {
+    if (y < base) {
+        return mulBySmall(x, static_cast<uint32_t>(y));
+    }
+    return mulLimbs(x, fromUint64(y));
+}
+//pi = 426880 * sqrt(10005) / sum_k (-1)^k (6k)! (13591409 + 545140134 k) / ((3k)! (k!)^3 640320^(3k)).
+//Term k relates to term k - 1 by p(k) / q(k) with p(k) = -(6k - 5)(2k - 1)(6k - 1), q(k) = k^3 640320^3 / 24.
+//For a range: P = prod p, Q = prod q, T = sum of the terms scaled by Q; halves merge as
+//P = P1 P2, Q = Q1 Q2, T = T1 Q2 + P1 T2
+PiEngine::Split PiEngine::chudnovsky(uint64_t a, uint64_t b) {
+    if (b - a == 1) {
+        Split s;
+        if (a == 0) {
+            s.P = {fromUint64(1), false};
+            s.Q = {fromUint64(1), false};
+        } else {
+            s.P = {mulByTerm(mulByTerm(fromUint64(6 * a - 5), 2 * a - 1), 6 * a - 1), true};
+            s.Q = {mulByTerm(mulByTerm(mulByTerm(fromUint64(10939058860032000ull), a), a), a), false};
+        }
+        s.T = mul(s.P, {fromUint64(13591409 + 545140134 * a), false});
+        return s;
+    }
+    Split left, right;
+    splitRange(a, b, left, right, chudnovsky);
+    Split s;
+    s.P = mul(left.P, right.P);
+    s.Q = mul(left.Q, right.Q);
+    s.T = add(mul(left.T, right.Q), mul(left.P, right.T));
+    return s;
+}
+//pi = 16 * sum_k (120k^2 + 151k + 47) / ((8k + 1)(2k + 1)(8k + 5)(4k + 3) 16^(k + 1)).
+//For a range: B = product of the denominators, Q = 16^(b - a), T = the sum scaled by B Q; halves merge as
+//B = B1 B2, Q = Q1 Q2, T = T1 B2 Q2 + T2 B1
+PiEngine::Split PiEngine::bbp(uint64_t a, uint64_t b) {
+    if (b - a == 1) {
+        Split s;
+        s.T = {fromUint64(120 * a * a + 151 * a + 47), false};
+        s.B = mulByTerm(mulByTerm(mulByTerm(fromUint64(8 * a + 1), 2 * a + 1), 8 * a + 5), 4 * a + 3);
+        s.Q = {fromUint64(16), false};
+        return s;
+    }
+    Split left, right;
+    splitRange(a, b, left, right, bbp);
+    Split s;
+    s.B = mulLimbs(left.B, right.B);
+    s.Q = mul(left.Q, right.Q);
+    s.T = {sum(mulLimbs(mulLimbs(left.T.limbs, right.B), right.Q.limbs), mulLimbs(right.T.limbs, left.B)), false};
+    return s;
+}
+//e = sum_k 1 / k!. For a range (a, b]: Q = (a + 1) ... b and T = sum of Q / ((a + 1) ... k); halves merge as
+//Q = Q1 Q2, T = T1 Q2 + T2
+PiEngine::Split PiEngine::eSeries(uint64_t a, uint64_t b) {
+    if (b - a == 1) {
+        Split s;
+        s.Q = {fromUint64(b), false};
+        s.T = {fromUint64(1), false};
+        return s;
+    }
+    Split left, right;
+    splitRange(a, b, left, right, eSeries);
+    Split s;
+    s.Q = mul(left.Q, right.Q);
+    s.T = add(mul(left.T, right.Q), right.T);
+    return s;
+}
+//ln 2 = 2 atanh(1/3) = 6 * sum_k 1 / ((2k + 1) 9^(k + 1)).
+//For a range: B = product of the 2k + 1, Q = 9^(b - a), T = the sum scaled by B Q; halves merge like BBP ones
+PiEngine::Split PiEngine::ln2Series(uint64_t a, uint64_t b) {
+    if (b - a == 1) {
+        Split s;
+        s.T = {fromUint64(1), false};
+        s.B = fromUint64(2 * a + 1);
+        s.Q = {fromUint64(9), false};
+        return s;
+    }
+    Split left, right;
+    splitRange(a, b, left, right, ln2Series);
+    Split s;
+    s.B = mulLimbs(left.B, right.B);
+    s.Q = mul(left.Q, right.Q);
+    s.T = {sum(mulLimbs(mulLimbs(left.T.limbs, right.B), right.Q.limbs), mulLimbs(right.T.limbs, left.B)), false};
+    return s;
+}
+
+std::vector<uint32_t> PiEngine::fixedPoint(size_t fracLimbs, PiSeries series) {
+    size_t limbs = fracLimbs + guardLimbs;
+    double digits = static_cast<double>(limbs * digitsPerLimb);
+    LimbVector num, den;
+    if (series == PiSeries::Chudnovsky) {
+        Split s = chudnovsky(0, static_cast<uint64_t>(digits / 14.18) + 2);
+        LimbVector radicand = fromUint64(10005);
+        radicand.insert(radicand.begin(), 2 * limbs, 0);
+        num = mulLimbs(mulBySmall(s.Q.limbs, 426880), isqrt(radicand));
+        den = s.T.limbs;
+    } else {
+        Split s = bbp(0, static_cast<uint64_t>(digits / 1.2041) + 2);
+        num = mulBySmall(s.T.limbs, 16);
+        num.insert(num.begin(), limbs, 0);
+        den = mulLimbs(s.B, s.Q.limbs);
+    }
+    LimbVector q = divide(num, den);
+    return std::vector<uint32_t>(q.begin() + guardLimbs, q.end());
+}
+std::vector<uint32_t> PiEngine::eFixedPoint(size_t fracLimbs) {
+    size_t limbs = fracLimbs + guardLimbs;
+    double digits = static_cast<double>(limbs * digitsPerLimb), logFactorial = 0;
+    uint64_t terms = 1;
+    while (logFactorial <= digits) {
+        logFactorial += std::log10(static_cast<double>(++terms));
+    }
+    Split s = eSeries(0, terms);
+    //e = 1 + T / Q
+    LimbVector num = sum(s.T.limbs, s.Q.limbs);
+    num.insert(num.begin(), limbs, 0);
+    LimbVector q = divide(num, s.Q.limbs);
+    return std::vector<uint32_t>(q.begin() + guardLimbs, q.end());
+}
+std::vector<uint32_t> PiEngine::ln2FixedPoint(size_t fracLimbs) {
+    size_t limbs = fracLimbs + guardLimbs;
+    double digits = static_cast<double>(limbs * digitsPerLimb);
+    Split s = ln2Series(0, static_cast<uint64_t>(digits / 0.9542) + 2);
+    LimbVector num = mulBySmall(s.T.limbs, 6);
+    num.insert(num.begin(), limbs, 0);
+    LimbVector q = divide(num, mulLimbs(s.B, s.Q.limbs));
+    //The quotient comes back trimmed, the zero integer limb is put back
+    q.resize(limbs + 1);
+    return std::vector<uint32_t>(q.begin() + guardLimbs, q.end());
+}
+std::string PiEngine::digits(size_t digits, PiSeries series) {
+    int fracLimbs = static_cast<int>((digits + digitsPerLimb - 1) / digitsPerLimb);
+    std::vector<uint32_t> limbs = fixedPoint(fracLimbs, series);
+    return format(0, limbs.data(), limbs.size(), fracLimbs, digits);
+}
+void PiEngine::write(std::ostream &out, const std::vector<uint32_t> &fixedPoint, size_t digits) {
+    int fracLimbs = static_cast<int>((digits + digitsPerLimb - 1) / digitsPerLimb);
+    BigFloatBase::write(out, 0, fixedPoint.data(), fixedPoint.size(), fracLimbs, digits);
+}
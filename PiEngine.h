@@ -0,0 +1,57 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "BigFloat.h"
+
+enum class PiSeries {
+    Chudnovsky, //~14.18 digits per term
+    BBP         //~1.2 digits per term
+};
+
+//Evaluates pi by binary splitting: the terms of a range are combined into exact integers P, Q and T,
+//halves of a range are merged with a few big multiplications and only one division is done at the very end.
+//Large ranges are split across the library task pool. e and ln 2 are evaluated the same way
+class PiEngine : public BigFloatBase {
+public:
+    //floor(pi * base^fracLimbs) as little-endian limbs, fraction first like BasicBigFloat
+    static std::vector<uint32_t> fixedPoint(size_t fracLimbs, PiSeries series = PiSeries::Chudnovsky);
+    //"3." followed by `digits` decimal digits of pi
+    static std::string digits(size_t digits, PiSeries series = PiSeries::Chudnovsky);
+    //floor(e * base^fracLimbs) and floor(ln 2 * base^fracLimbs) in the same format
+    static std::vector<uint32_t> eFixedPoint(size_t fracLimbs);
+    static std::vector<uint32_t> ln2FixedPoint(size_t fracLimbs);
+    //Streams `digits` decimal digits of fixedPoint((digits + 8) / 9)
+    static void write(std::ostream &out, const std::vector<uint32_t> &fixedPoint, size_t digits);
+    template<int FracDigits>
+    static BasicBigFloat<FracDigits> pi(PiSeries series = PiSeries::Chudnovsky);
+
+private:
+    //Integer with a sign, P and T of the Chudnovsky series alternate
+    struct Integer {
+        LimbVector limbs;
+        bool negative = false;
+    };
+    //Sum of the terms of a range: T / (Q * B) for BBP, with P = prod p(k) for Chudnovsky
+    struct Split {
+        Integer P, Q, T;
+        LimbVector B;
+    };
+    static Integer mul(const Integer &x, const Integer &y);
+    static Integer add(const Integer &x, const Integer &y);
+    static LimbVector fromUint64(uint64_t x);
+    //x * y for any y, mulBySmall only takes factors below base
+    static LimbVector mulByTerm(const LimbVector &x, uint64_t y);
+    static Split chudnovsky(uint64_t a, uint64_t b);
+    static Split bbp(uint64_t a, uint64_t b);
+    static Split eSeries(uint64_t a, uint64_t b);
+    static Split ln2Series(uint64_t a, uint64_t b);
+};
+
+template<int FracDigits>
+BasicBigFloat<FracDigits> PiEngine::pi(PiSeries series) {
+    constexpr size_t fracLimbs = (FracDigits + digitsPerLimb - 1) / digitsPerLimb;
+    std::vector<uint32_t> limbs = fixedPoint(fracLimbs, series);
+    std::vector<uint32_t> intPart(limbs.begin() + fracLimbs, limbs.end());
+    limbs.resize(fracLimbs);
+    return BasicBigFloat<FracDigits>(intPart, limbs, 0);
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include "BigFloat.h"
+#include "TaskPool.h"
+
+//Sum of the terms of [begin, end) at FracDigits digits, evaluated in chunks spread across the library task pool.
+//A chunk starting at term k calls init(k) once and then term(state, k) for each of its terms in order, so what the
+//terms build on, such as a running power, is carried from one term to the next rather than recomputed for each.
+//Halves of a range are summed independently and merged in a tree by their accumulators, without a lock.
+//init and term are called from several threads at once
+template<int FracDigits, class Init, class Term>
+BasicBigFloat<FracDigits> parallelSeries(uint64_t begin, uint64_t end, Init init, Term term);
+//Same for terms that need no state, term(k) returns term k
+template<int FracDigits, class Term>
+BasicBigFloat<FracDigits> parallelSeries(uint64_t begin, uint64_t end, Term term);
+
+//Ranges of at most grain terms are summed into sum on the calling thread, larger ones offer their left half to the pool
+template<int FracDigits, class Init, class Term>
+void parallelSeriesRange(uint64_t begin, uint64_t end, uint64_t grain, Init &init, Term &term,
+                         BasicBigFloatAccumulator<FracDigits> &sum) {
+    if (end - begin <= grain) {
+        auto state = init(begin);
+        for (uint64_t k = begin; k < end; ++k) {
+            sum += term(state, k);
+        }
+        return;
+    }
+    uint64_t mid = begin + (end - begin) / 2;
+    BasicBigFloatAccumulator<FracDigits> left;
+    auto leftHalf = TaskPool::task([&] { parallelSeriesRange(begin, mid, grain, init, term, left); });
+    //Joined even when the right half throws
+    TaskPool::Group group;
+    group.fork(leftHalf);
+    parallelSeriesRange(mid, end, grain, init, term, sum);
+    group.join();
+    sum += left;
+}
+
+template<int FracDigits, class Init, class Term>
+BasicBigFloat<FracDigits> parallelSeries(uint64_t begin, uint64_t end, Init init, Term term) {
+    BasicBigFloatAccumulator<FracDigits> sum;
+    if (begin < end) {
+        //A few chunks per worker even out terms of uneven cost, a serial pool keeps the whole range in one chunk
+        unsigned workers = TaskPool::instance().workers();
+        uint64_t chunks = workers ? 8 * (workers + 1) : 1;
+        uint64_t grain = std::max<uint64_t>(1, (end - begin + chunks - 1) / chunks);
+        parallelSeriesRange(begin, end, grain, init, term, sum);
+    }
+    return sum.result();
+}
+template<int FracDigits, class Term>
+BasicBigFloat<FracDigits> parallelSeries(uint64_t begin, uint64_t end, Term term) {
+    return parallelSeries<FracDigits>(begin, end, [](uint64_t) { return 0; }, [&](int, uint64_t k) { return term(k); });
+}
@@ -0,0 +1,187 @@
+#include <stdexcept>
+#include "TaskPool.h"
+
+namespace {
+    //Queue index of the worker running on this thread
+    thread_local size_t currentWorker = static_cast<size_t>(-1);
+}
+
+TaskPool::TaskPool() {
+    unsigned hardware = std::thread::hardware_concurrency();
+    //The thread that forks works as well
+    start(hardware > 1 ? hardware - 1 : 0);
+}
+TaskPool::~TaskPool() {
+    stop();
+}
+TaskPool &TaskPool::instance() {
+    static TaskPool pool;
+    return pool;
+}
+unsigned TaskPool::workers() const {
+    return static_cast<unsigned>(threads.size());
+}
+void TaskPool::setWorkers(unsigned n) {
+    stop();
+    start(n);
+}
+void TaskPool::start(unsigned n) {
+    queues.clear();
+    for (unsigned i = 0; i <= n; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (unsigned i = 0; i < n; ++i) {
+        threads.emplace_back(&TaskPool::workerLoop, this, i);
+    }
+}
+void TaskPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    threads.clear();
+    stopping = false;
+}
+
+void TaskPool::workerLoop(size_t self) {
+    currentWorker = self;
+    while (true) {
+        if (Task *t = take(self)) {
+            execute(*t);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        if (stopping) {
+            return;
+        }
+        ++idle;
+        wake.wait(lock, [this] { return stopping || pending.load() > 0; });
+        --idle;
+    }
+}
+TaskPool::Task *TaskPool::take(size_t self) {
+    size_t n = queues.size();
+    {
+        Queue &q = *queues[self];
+        std::lock_guard<std::mutex> lock(q.m);
+        if (q.size) {
+            --q.size;
+            --pending;
+            return q.tasks[(q.head + q.size) % queueCapacity];
+        }
+    }
+    for (size_t i = 1; i < n; ++i) {
+        Queue &q = *queues[(self + i) % n];
+        std::lock_guard<std::mutex> lock(q.m);
+        if (q.size) {
+            Task *t = q.tasks[q.head];
+            q.head = (q.head + 1) % queueCapacity;
+            --q.size;
+            --pending;
+            return t;
+        }
+    }
+    return nullptr;
+}
+void TaskPool::execute(Task &t) {
+    try {
+        t.run();
+    } catch (...) {
+        t.error = std::current_exception();
+    }
+    t.done.store(true, std::memory_order_release);
+}
+
+void TaskPool::fork(Task &t) {
+    t.queue = notQueued;
+    if (idle.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    size_t self = currentWorker == notQueued ? queues.size() - 1 : currentWorker;
+    Queue &q = *queues[self];
+    ++pending;
+    {
+        std::lock_guard<std::mutex> lock(q.m);
+        if (q.size == queueCapacity) {
+            --pending;
+            return;
+        }
+        q.tasks[(q.head + q.size) % queueCapacity] = &t;
+        ++q.size;
+    }
+    t.queue = self;
+    {
+        //Taking the lock orders the push before a worker that is about to sleep checks `pending`
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wake.notify_one();
+}
+void TaskPool::join(Task &t) {
+    bool runHere = t.queue == notQueued;
+    if (!runHere) {
+        Queue &q = *queues[t.queue];
+        std::lock_guard<std::mutex> lock(q.m);
+        for (size_t i = q.size; i-- > 0;) {
+            if (q.tasks[(q.head + i) % queueCapacity] != &t) {
+                continue;
+            }
+            for (size_t j = i; j + 1 < q.size; ++j) {
+                q.tasks[(q.head + j) % queueCapacity] = q.tasks[(q.head + j + 1) % queueCapacity];
+            }
+            --q.size;
+            --pending;
+            runHere = true;
+            break;
+        }
+    }
+    if (runHere) {
+        t.run();
+        return;
+    }
+    size_t self = currentWorker == notQueued ? queues.size() - 1 : currentWorker;
+    while (!t.done.load(std::memory_order_acquire)) {
+        if (Task *other = take(self)) {
+            execute(*other);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    if (t.error) {
+        std::rethrow_exception(t.error);
+    }
+}
+
+TaskPool::Group::~Group() {
+    while (count) {
+        try {
+            pool.join(*tasks[--count]);
+        } catch (...) {
+        }
+    }
+}
+void TaskPool::Group::fork(Task &t) {
+    if (count == maxTasks) {
+        throw std::logic_error("TaskPool::Group holds at most maxTasks tasks");
+    }
+    tasks[count++] = &t;
+    pool.fork(t);
+}
+void TaskPool::Group::join() {
+    std::exception_ptr error;
+    while (count) {
+        try {
+            pool.join(*tasks[--count]);
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+//Fork-join pool used inside single BigFloat operations.
+//Every worker owns a deque: it pops its newest tasks while idle workers steal the oldest ones.
+//Tasks live in the frame that forks them, so forking and joining never allocate
+class TaskPool {
+public:
+    class Task {
+    public:
+        virtual void run() = 0;
+    protected:
+        ~Task() = default;
+    private:
+        friend class TaskPool;
+        std::atomic<bool> done{false};
+        std::exception_ptr error;
+        size_t queue = 0;
+    };
+    template<class F>
+    class FnTask : public Task {
+    public:
+        explicit FnTask(F f) : f(std::move(f)) {}
+        void run() override { f(); }
+    private:
+        F f;
+    };
+    template<class F>
+    static FnTask<F> task(F f) { return FnTask<F>(std::move(f)); }
+    //Up to maxTasks tasks forked from one frame. join() waits for all of them and rethrows the first error once
+    //they have finished; tasks still forked when the group goes out of scope, because an exception is leaving the
+    //frame, are joined there and their errors dropped. Declare the group after the tasks and the memory they use
+    class Group {
+    public:
+        static constexpr size_t maxTasks = 4;
+        Group() : pool(instance()) {}
+        Group(const Group &) = delete;
+        Group &operator=(const Group &) = delete;
+        ~Group();
+        void fork(Task &t);
+        //Newest task first
+        void join();
+    private:
+        TaskPool &pool;
+        std::array<Task *, maxTasks> tasks{};
+        size_t count = 0;
+    };
+
+    static TaskPool &instance();
+    [[nodiscard]] unsigned workers() const;
+    //Stops the current workers and starts n new ones. Must not be called while operations are in flight
+    void setWorkers(unsigned n);
+    //Offers t to the workers. When none of them is idle t is left to join, so callers that are already
+    //parallel do not oversubscribe the machine
+    void fork(Task &t);
+    //Returns once t has finished: runs it here if no worker took it, otherwise helps with other tasks meanwhile.
+    //Rethrows the exception t finished with
+    void join(Task &t);
+
+    TaskPool(const TaskPool &) = delete;
+    TaskPool &operator=(const TaskPool &) = delete;
+    ~TaskPool();
+
+private:
+    static constexpr size_t queueCapacity = 256;
+    static constexpr size_t notQueued = static_cast<size_t>(-1);
+    //Ring buffer of forked tasks, the newest one is at the back
+    struct Queue {
+        std::mutex m;
+        std::array<Task *, queueCapacity> tasks{};
+        size_t head = 0, size = 0;
+    };
+
+    TaskPool();
+    void start(unsigned n);
+    void stop();
+    void workerLoop(size_t self);
+    //Own queue from the back, then the other ones from the front
+    Task *take(size_t self);
+    static void execute(Task &t);
+
+    //One queue per worker plus the last one shared by outside threads
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<unsigned> idle{0};
+    std::atomic<size_t> pending{0};
+    bool stopping = false;
+};
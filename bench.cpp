@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "BigFloat.h"
+#include "BigFloatArray.h"
+#include "FloatingBigFloat.h"
+
+//Times every operator over a sweep of precisions and operand sizes and prints the results as JSON:
+//median and p99 time per operation in nanoseconds and heap allocations per operation.
+//Pass --quick to run every case for a fraction of the default time
+
+namespace {
+    struct Result {
+        std::string name;
+        int precision;
+        size_t operandLimbs;
+        size_t iterations;
+        double medianNs, p99Ns, allocationsPerOp;
+    };
+
+    double targetSeconds = 0.2;
+    //Results of comparisons end up here so they are not optimised away
+    volatile bool sink;
+    std::mt19937_64 rng(2024);
+
+    //A batch is timed as a whole so the clock resolution does not distort cheap operations
+    Result measure(const std::string &name, int precision, size_t operandLimbs, const std::function<void()> &op) {
+        using clock = std::chrono::steady_clock;
+        auto start = clock::now();
+        op();
+        double once = std::chrono::duration<double>(clock::now() - start).count();
+        size_t batch = std::max<size_t>(1, static_cast<size_t>(1e-5 / std::max(once, 1e-9)));
+        size_t batches = std::clamp<size_t>(static_cast<size_t>(targetSeconds / std::max(once * batch, 1e-9)), 5, 2000);
+
+        std::vector<double> samples;
+        samples.reserve(batches);
+        uint64_t allocations = BigFloat::allocationCount();
+        for (size_t i = 0; i < batches; ++i) {
+            auto batchStart = clock::now();
+            for (size_t j = 0; j < batch; ++j) {
+                op();
+            }
+            samples.push_back(std::chrono::duration<double, std::nano>(clock::now() - batchStart).count() / batch);
+        }
+        allocations = BigFloat::allocationCount() - allocations;
+        std::sort(samples.begin(), samples.end());
+        size_t iterations = batches * batch;
+        return {name, precision, operandLimbs, iterations, samples[samples.size() / 2],
+                samples[std::min(samples.size() - 1, samples.size() * 99 / 100)],
+                static_cast<double>(allocations) / iterations};
+    }
+
+    std::string randomDigits(size_t n) {
+        std::string s(n, '0');
+        for (auto &c : s) c = static_cast<char>('0' + rng() % 10);
+        s[0] = static_cast<char>('1' + rng() % 9);
+        return s;
+    }
+
+    template<int Precision>
+    void benchPrecision(std::vector<Result> &results) {
+        using Number = BasicBigFloat<Precision>;
+        for (size_t intDigits : {9, Precision / 2 + 9}) {
+            std::string textA = randomDigits(intDigits) + "." + randomDigits(Precision);
+            std::string textB = "-" + randomDigits(intDigits) + "." + randomDigits(Precision);
+            Number a(textA.c_str()), b(textB.c_str()), absB = abs(b), c(0);
+            //Same value as a except for the last digit, comparisons have to walk every limb
+            std::string textNear = textA;
+            textNear.back() = textNear.back() == '9' ? '8' : static_cast<char>(textNear.back() + 1);
+            Number near(textNear.c_str());
+            size_t limbs = (intDigits + Precision + 8) / 9;
+            bool flag = false;
+
+            results.push_back(measure("add", Precision, limbs, [&] { c = a + absB; }));
+            results.push_back(measure("sub", Precision, limbs, [&] { c = a - absB; }));
+            results.push_back(measure("add_mixed_signs", Precision, limbs, [&] { c = a + b; }));
+            results.push_back(measure("mul", Precision, limbs, [&] { c = a * b; }));
+            results.push_back(measure("sqr", Precision, limbs, [&] { c = a * a; }));
+            results.push_back(measure("div", Precision, limbs, [&] { c = a / b; }));
+            results.push_back(measure("mul_word", Precision, limbs, [&] { c = a * 1234567891011ull; }));
+            //Intermediates that only need half of the digits
+            results.push_back(measure("product_half", Precision, limbs, [&] { c = product(a, b, Precision / 2); }));
+            results.push_back(measure("quotient_half", Precision, limbs, [&] { c = quotient(a, b, Precision / 2); }));
+            results.push_back(measure("div_word", Precision, limbs, [&] { c = a / 1234567891011ull; }));
+            results.push_back(measure("add_word", Precision, limbs, [&] { c = a + 16; }));
+            //Whole-number operands as they appear in series code, e.g. x * BigFloat(8 * i + 4)
+            results.push_back(measure("mul_whole", Precision, limbs, [&] { c = a * Number(16); }));
+            results.push_back(measure("div_whole", Precision, limbs, [&] { c = a / Number(16); }));
+            results.push_back(measure("copy", Precision, limbs, [&] { c = a; }));
+            BasicBigFloatAccumulator<Precision> acc;
+            results.push_back(measure("accumulate", Precision, limbs, [&] { acc += a; }));
+            results.push_back(measure("less", Precision, limbs, [&] { flag ^= a < near; }));
+            results.push_back(measure("equal", Precision, limbs, [&] { flag ^= a == near; }));
+            results.push_back(measure("parse", Precision, limbs, [&] { c = Number(textA.c_str()); }));
+            double value = 0;
+            int64_t whole = 0;
+            results.push_back(measure("to_double", Precision, limbs, [&] { value += a.toDouble(); }));
+            results.push_back(measure("estimate", Precision, limbs, [&] { value += a.estimate(); }));
+            results.push_back(measure("from_double", Precision, limbs, [&] { c = Number(3.14159); }));
+            results.push_back(measure("from_int64", Precision, limbs, [&] { c = Number(int64_t(-1234567891011121314)); }));
+            Number fitting("-1234567891011.5");
+            results.push_back(measure("to_int64", Precision, limbs, [&] { whole += fitting.toInt64(); }));
+            results.push_back(measure("to_string", Precision, limbs, [&] { flag ^= a.toString(Precision).size() & 1; }));
+            std::stringstream binary;
+            results.push_back(measure("serialize", Precision, limbs, [&] { binary.str({}); a.serialize(binary); }));
+            binary.str({});
+            a.serialize(binary);
+            results.push_back(measure("deserialize", Precision, limbs, [&] { binary.seekg(0); c = Number::deserialize(binary); }));
+            sink = flag ^ (value > 0) ^ (whole > 0);
+        }
+    }
+
+    //Floating values far from 1 cost what values near 1 do, the operands are around 10^1200 and 10^-1200
+    template<int Precision>
+    void benchFloating(std::vector<Result> &results) {
+        using Number = BasicFloatingBigFloat<Precision>;
+        Number a((randomDigits(Precision) + "e1200").c_str()), b(("-" + randomDigits(Precision) + "e-1200").c_str()), c(0);
+        size_t limbs = Number::mantissaLimbs;
+        results.push_back(measure("float_add", Precision, limbs, [&] { c = a + abs(b); }));
+        results.push_back(measure("float_mul", Precision, limbs, [&] { c = a * b; }));
+        results.push_back(measure("float_div", Precision, limbs, [&] { c = a / b; }));
+    }
+
+    //Batch operations over 1024 elements, timed per element against the loop over BigFloat they replace
+    template<int Precision>
+    void benchArray(std::vector<Result> &results) {
+        using Number = BasicBigFloat<Precision>;
+        using Array = BasicBigFloatArray<Precision>;
+        const size_t n = 1024;
+        std::vector<Number> x, y;
+        for (size_t i = 0; i < n; ++i) {
+            x.emplace_back((randomDigits(9) + "." + randomDigits(Precision)).c_str());
+            y.emplace_back(("-" + randomDigits(9) + "." + randomDigits(Precision)).c_str());
+        }
+        std::vector<Number> z = x;
+        Array a(x), b(y), c(n);
+        Number alpha = x[0], d(0);
+        size_t limbs = Array::fracLimbs + 1;
+        auto perElement = [&](const std::string &name, const std::function<void()> &op) {
+            Result r = measure(name, Precision, limbs, op);
+            r.medianNs /= n;
+            r.p99Ns /= n;
+            r.allocationsPerOp /= n;
+            results.push_back(r);
+        };
+        perElement("array_add", [&] { Array::add(c, a, b); });
+        perElement("array_mul", [&] { Array::mul(c, a, b); });
+        perElement("array_fma", [&] { Array::fma(c, a, b, c); });
+        perElement("array_axpy", [&] { Array::axpy(c, alpha, a); });
+        perElement("array_dot", [&] { d = Array::dot(a, b); });
+        perElement("loop_mul", [&] { for (size_t i = 0; i < n; ++i) z[i] = x[i] * y[i]; });
+        perElement("loop_dot", [&] {
+            BasicBigFloatAccumulator<Precision> acc;
+            for (size_t i = 0; i < n; ++i) acc += x[i] * y[i];
+            d = acc.result();
+        });
+    }
+
+    //Exposes the limb kernels so they can be timed against each other and across instruction sets
+    struct Kernels : BigFloatBase {
+        static void benchmark(std::vector<Result> &results) {
+            const Simd detected = simd();
+            const std::pair<Simd, const char *> levels[] = {{Simd::Scalar, "scalar"}, {Simd::AVX2, "avx2"}, {Simd::AVX512, "avx512"}};
+            for (size_t len : {8, 16, 24, 32, 48, 64, 96, 128, 192, 256, 512}) {
+                std::vector<uint32_t> x(len), y(len), res(2 * len);
+                for (auto &limb : x) limb = rng() % base;
+                for (auto &limb : y) limb = rng() % base;
+                for (auto [level, name] : levels) {
+                    if (level > detected) {
+                        break;
+                    }
+                    setSimd(level);
+                    std::string suffix = std::string("_") + name;
+                    results.push_back(measure("naive_mul" + suffix, 0, len, [&] { naive_mul(res.data(), x.data(), len, y.data(), len); }));
+                    results.push_back(measure("naive_sqr" + suffix, 0, len, [&] { naive_sqr(res.data(), x.data(), len); }));
+                    results.push_back(measure("sum" + suffix, 0, len, [&] { sum(res.data(), x.data(), len, y.data(), len); }));
+                    results.push_back(measure("substract" + suffix, 0, len, [&] { substract(res.data(), x.data(), len, y.data(), len); }));
+                }
+                setSimd(detected);
+                //One level of recursion over naive products, which is what the cutoff decides
+                auto thresholds = mulThresholds();
+                setMulThresholds({len - 1, SIZE_MAX, thresholds.ntt});
+                results.push_back(measure("karatsuba_mul", 0, len, [&] { karatsuba_mul(res.data(), x.data(), y.data(), len); }));
+                //One Toom-3 level over the default lower tiers
+                if (len >= 96) {
+                    setMulThresholds({thresholds.karatsuba, len, thresholds.ntt});
+                    results.push_back(measure("toom3_mul", 0, len, [&] { toom3_mul(res.data(), x.data(), y.data(), len); }));
+                }
+                setMulThresholds(thresholds);
+            }
+            //Lopsided products are cut into balanced blocks of the short length
+            std::vector<uint32_t> x(4096), res(8192);
+            for (auto &limb : x) limb = rng() % base;
+            for (size_t len : {16, 64, 256, 1024}) {
+                results.push_back(measure("mult_lopsided_4096", 0, len, [&] { mult(res.data(), x.data(), x.size(), x.data() + 4096 - len, len); }));
+            }
+        }
+    };
+
+    void print(const std::vector<Result> &results) {
+        std::cout << "{\n  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result &r = results[i];
+            std::cout << "    {\"name\": \"" << r.name << "\", \"precision\": " << r.precision
+                      << ", \"operand_limbs\": " << r.operandLimbs << ", \"iterations\": " << r.iterations
+                      << ", \"median_ns\": " << r.medianNs << ", \"p99_ns\": " << r.p99Ns
+                      << ", \"allocations_per_op\": " << r.allocationsPerOp << "}"
+                      << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        std::cout << "  ]\n}\n";
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "--quick") == 0) {
+        targetSeconds = 0.01;
+    }
+    std::vector<Result> results;
+    benchPrecision<128>(results);
+    benchPrecision<1000>(results);
+    benchPrecision<10000>(results);
+    benchPrecision<100000>(results);
+    benchFloating<128>(results);
+    benchFloating<1000>(results);
+    benchFloating<10000>(results);
+    benchArray<128>(results);
+    benchArray<1000>(results);
+    Kernels::benchmark(results);
+    print(results);
+    return 0;
+}
@@ -1,51 +1,21 @@
 #include <chrono>
-#include <thread>
-#include <mutex>
+#include <cstring>
 #include <iostream>
-#include "BigFloat.h"
-
-//https://habr.com/ru/articles/443998/
-void CalcPi(BigFloat &pi, const int k_start, const int k_finish, const BigFloat &bs) {
-    static BigFloat one = 1._bf;
-    static BigFloat two = 2._bf;
-    static BigFloat four = 4._bf;
-    static std::mutex m;
-    BigFloat base = bs;
-    BigFloat res = 0.0_bf;
-    for(int i = k_start; i < k_finish; ++i) {
-        res = res + ((four / BigFloat(8 * i + 1)) -
-                     (two / BigFloat(8 * i + 4)) -
-                     (one / BigFloat(8 * i + 5)) -
-                     (one / BigFloat(8 * i + 6))) / base;
-        base = base * BigFloat(16);
-    }
-    m.lock();
-    pi = pi + res;
-    m.unlock();
-}
+#include "PiEngine.h"
 
+//Pass "bbp" as the first argument to use the BBP series instead of the Chudnovsky one
 int main(int argc, char**argv) {
+    PiSeries series = argc > 1 && strcmp(argv[1], "bbp") == 0 ? PiSeries::BBP : PiSeries::Chudnovsky;
     std::cout << "Enter the precision of pi you want to get (number of digits after dot)" << std::endl;
     int prec;
     std::cin >> prec;
-    int n = (prec + 15) / 16 * 16;
-    int signs = n / 16;
     auto start = std::chrono::high_resolution_clock::now();
-    BigFloat pi = 0._bf;
-    BigFloat curBs = 1._bf;
-    //Let's use 16 threads to calculate pi
-    std::vector<std::thread> threads;
-
-    for (int k = 0; k <= n; k++) {
-        if (k % signs == 0)
-            threads.emplace_back(CalcPi, std::ref(pi), k, k+signs, curBs);
-        curBs = curBs * BigFloat(16);
-    }
-    for (auto &thread: threads)
-        thread.join();
+    std::vector<uint32_t> pi = PiEngine::fixedPoint((prec + 8) / 9, series);
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
     std::cout << "Pi with needed precision: ";
-    display(pi, prec);
+    PiEngine::write(std::cout, pi, prec);
+    std::cout << '\n';
     std::cout << "Total time (in ms) " << duration.count() << '\n';
+    std::cout << "Digits per second " << static_cast<long long>(prec * 1000.0 / std::max<long long>(duration.count(), 1)) << '\n';
     return 0;
-}
\ No newline at end of file
+}
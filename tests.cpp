@@ -1,6 +1,24 @@
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <cstdio>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
 #include "BigFloat.h"
+#include "PiEngine.h"
+#include "Constants.h"
+#include "BigFloatTable.h"
+#include "Series.h"
+#include "TaskPool.h"
+#include "FloatingBigFloat.h"
+#include "BigFloatArray.h"
 #include "catch2/catch_session.hpp"
 #include "catch2/generators/catch_generators.hpp"
 #include <catch2/catch_test_macros.hpp>
@@ -43,11 +61,232 @@ TEST_CASE("[BigFloat operators]", "[All]") {
         int b = GENERATE(take(10,random(-100, 100)));
         REQUIRE(BigFloat(a) * BigFloat(b) == BigFloat(a * b));
     }
+    SECTION("/ and reciprocal") {
+        int a = GENERATE(take(10,random(-1000, 1000)));
+        int b = GENERATE(take(10,random(1, 1000)));
+        REQUIRE(BigFloat(a * b) / BigFloat(b) == BigFloat(a));
+        REQUIRE((BigFloat(1) / BigFloat(3)).toString(30) == "0.333333333333333333333333333333");
+        REQUIRE((BigFloat(-2) / BigFloat(7)).toString(18) == "-0.285714285714285714");
+        REQUIRE(abs(BigFloat(a) * BigFloat(b).reciprocal() - BigFloat(a) / BigFloat(b)) < BigFloat("0.000000000000000000000000000001"));
+    }
+    SECTION("/ by divisors past the precision") {
+        //The divisor has more low zero limbs than the scaled dividend has limbs
+        unsigned exponent = GENERATE(200u, 300u, 2000u);
+        REQUIRE(BigFloat(1) / pow(BigFloat(10), exponent) == BigFloat(0));
+        REQUIRE(BigFloat("-0.5") / pow(BigFloat(10), exponent) == BigFloat(0));
+        REQUIRE(BasicBigFloat<1000>(1) / pow(BasicBigFloat<1000>(10), exponent * 10) == BasicBigFloat<1000>(0));
+    }
     SECTION("- whole numbers") {
         int a = GENERATE(take(10,random(-100, 100)));
         int b = GENERATE(take(10,random(-100, 100)));
         REQUIRE(BigFloat(a) - BigFloat(b) == BigFloat(a - b));
     }
+    SECTION("compound assignment and rvalue operands") {
+        int a = GENERATE(take(10,random(-1000, 1000)));
+        int b = GENERATE(take(10,random(1, 1000)));
+        BigFloat x = BigFloat(a) / BigFloat(7), y = BigFloat(-b) / BigFloat(3);
+        BigFloat res = x;
+        res += y;
+        REQUIRE(res == x + y);
+        res -= x;
+        REQUIRE(res == x + y - x);
+        res *= x;
+        REQUIRE(res == (x + y - x) * x);
+        res /= y;
+        REQUIRE(res == (x + y - x) * x / y);
+        REQUIRE(BigFloat(x) + y == x + y);
+        REQUIRE(x - BigFloat(y) == x - y);
+        REQUIRE(BigFloat(x) * BigFloat(y) == x * y);
+        REQUIRE(BigFloat(x) / y == x / y);
+        res = x;
+        res += res;
+        REQUIRE(res == x + x);
+        res -= res;
+        REQUIRE(res == BigFloat(0));
+    }
+    SECTION("scalar operands") {
+        int a = GENERATE(take(10,random(-100000, 100000)));
+        int64_t k = GENERATE(take(10,random(-3000000000000LL, 3000000000000LL)));
+        BigFloat x = BigFloat(a) / BigFloat(9);
+        BigFloat big = BigFloat(static_cast<int>(k % 1000000)) + BigFloat(static_cast<int>(k / 1000000)) * BigFloat(1000000);
+        REQUIRE(big + BigFloat(0) == BigFloat(0) + k);
+        REQUIRE(x * k == x * big);
+        REQUIRE(k * x == x * big);
+        REQUIRE(x / k == x / big);
+        REQUIRE(x + k == x + big);
+        REQUIRE(k + x == x + big);
+        REQUIRE(x - k == x - big);
+        REQUIRE(k - x == big - x);
+        REQUIRE(x * uint64_t(18000000000000000000ULL) / uint64_t(18000000000000000000ULL) == x);
+        REQUIRE(x * 16 == x * BigFloat(16));
+        REQUIRE(x * -3 == x * BigFloat(-3));
+        REQUIRE(x / -7 == x / BigFloat(-7));
+    }
+    SECTION("whole-number operands") {
+        int a = GENERATE(take(10,random(-100000, 100000)));
+        const char *text = GENERATE("7", "-999999999", "1000000000", "-123456789012345678901234567");
+        BigFloat x = BigFloat(a) / BigFloat(13), whole(text);
+        //Adding and removing an ulp leaves the value but drops what is known about its fraction
+        BigFloat ulp(("0." + std::string(125, '0') + "1").c_str()), general = whole + ulp - ulp;
+        REQUIRE(general == whole);
+        REQUIRE(x * whole == x * general);
+        REQUIRE(whole * x == general * x);
+        REQUIRE(x / whole == x / general);
+        REQUIRE(whole * whole == general * general);
+        REQUIRE((whole + BigFloat(a)) * whole == (general + BigFloat(a)) * general);
+        BigFloat res = whole;
+        res *= x;
+        REQUIRE(res == x * general);
+        res = x;
+        res /= whole;
+        REQUIRE(res == x / general);
+    }
+    SECTION("pow") {
+        REQUIRE(pow(BigFloat(2), 100).toString(1) == "1267650600228229401496703205376.0");
+        REQUIRE(pow(BigFloat(-3) / BigFloat(2), 3) == BigFloat("-3.375"));
+        REQUIRE(pow(BigFloat(7), 0) == BigFloat(1));
+        REQUIRE(pow(BigFloat("1.1"), 10).toString(20) == "2.59374246010000000000");
+    }
+}
+
+TEST_CASE("[BigFloat elementary functions]", "[All]") {
+    SECTION("known constants") {
+        REQUIRE(sqrt(BigFloat(2)).toString(100) == "1.4142135623730950488016887242096980785696718753769480731766797379907324784621070388503875343276415727");
+        REQUIRE(exp(BigFloat(1)).toString(100) == "2.7182818284590452353602874713526624977572470936999595749669676277240766303535475945713821785251664274");
+        REQUIRE(log(BigFloat(2)).toString(100) == "0.6931471805599453094172321214581765680755001343602552541206800094933936219696947156058633269964186875");
+        REQUIRE((atan(BigFloat(1)) * 4).toString(100) == PiEngine::digits(100));
+        REQUIRE(pow(BigFloat(10), BigFloat("0.5")).toString(50) == sqrt(BigFloat(10)).toString(50));
+        REQUIRE(log(BigFloat(10)).toString(20) == "2.30258509299404568401");
+        REQUIRE(exp(BigFloat("0.5")).toString(20) == "1.64872127070012814684");
+    }
+    SECTION("exact values") {
+        REQUIRE(sqrt(BigFloat(144)) == BigFloat(12));
+        REQUIRE(sqrt(BigFloat("0.0625")) == BigFloat("0.25"));
+        REQUIRE(sqrt(BigFloat(0)) == BigFloat(0));
+        REQUIRE(exp(BigFloat(0)) == BigFloat(1));
+        REQUIRE(log(BigFloat(1)) == BigFloat(0));
+        REQUIRE(atan(BigFloat(0)) == BigFloat(0));
+        REQUIRE(pow(BigFloat(0), BigFloat(3)) == BigFloat(0));
+    }
+    SECTION("inverse pairs agree up to the last digits") {
+        int a = GENERATE(take(10, random(1, 100000)));
+        BigFloat x = BigFloat(a) / 997;
+        BigFloat tolerance = BigFloat(1) / pow(BigFloat(10), 120);
+        REQUIRE(abs(exp(log(x)) - x) < tolerance);
+        REQUIRE(abs(log(exp(x / 100)) - x / 100) < tolerance);
+        BigFloat root = sqrt(x);
+        REQUIRE(root * root <= x);
+        REQUIRE(abs(root * root - x) < tolerance);
+        REQUIRE(atan(0 - x) == -atan(x));
+        REQUIRE(abs(pow(x, BigFloat(3)) - pow(x, 3u)) < tolerance);
+    }
+    SECTION("other precisions") {
+        REQUIRE(sqrt(BasicBigFloat<9>(2)) == BasicBigFloat<9>("1.414213562"));
+        REQUIRE(exp(BasicBigFloat<9>(-1)) == BasicBigFloat<9>("0.367879441"));
+        REQUIRE(log(BasicBigFloat<1000>(2)).toString(100) == log(BigFloat(2)).toString(100));
+        REQUIRE((atan(BasicBigFloat<1000>(1)) * 4).toString(1000) == PiEngine::digits(1000));
+    }
+    SECTION("domain errors") {
+        REQUIRE_THROWS_AS(sqrt(BigFloat(-2)), std::domain_error);
+        REQUIRE_THROWS_AS(log(BigFloat(0)), std::domain_error);
+        REQUIRE_THROWS_AS(log(BigFloat(-1)), std::domain_error);
+        REQUIRE_THROWS_AS(pow(BigFloat(-2), BigFloat("0.5")), std::domain_error);
+    }
+}
+
+TEST_CASE("[BigFloat target precision]", "[All]") {
+    using Number = BasicBigFloat<1000>;
+    std::mt19937_64 rng(7);
+    auto randomValue = [&](int intDigits, int leadingZeroes) {
+        std::string text = intDigits ? "" : "0";
+        for (int i = 0; i < intDigits; i++) text += static_cast<char>('1' + rng() % 9);
+        text += "." + std::string(leadingZeroes, '0');
+        for (int i = leadingZeroes; i < 1000; i++) text += static_cast<char>('0' + rng() % 10);
+        text = (rng() % 2 ? "-" : "") + text;
+        return Number(text.c_str());
+    };
+    auto unit = [](int digits) {
+        int limbs = (digits + 8) / 9;
+        return Number(1) / pow(Number(10), static_cast<unsigned>(limbs * 9));
+    };
+    SECTION("products and quotients keep the requested digits") {
+        int digits = GENERATE(1, 9, 100, 500, 999, 1000, 5000);
+        for (int i = 0; i < 20; i++) {
+            Number a = randomValue(rng() % 30, rng() % 600), b = randomValue(rng() % 30, rng() % 600);
+            Number p = product(a, b, digits), q = quotient(a, b, digits);
+            int kept = std::min(digits, 1000);
+            REQUIRE(abs(p - a * b) < unit(kept) * 2);
+            REQUIRE(abs(q - a / b) < unit(kept) * 2);
+            std::string tail = p.toString(1008).substr(p.toString(1008).find('.') + 1 + (kept + 8) / 9 * 9);
+            REQUIRE(tail.find_first_not_of('0') == std::string::npos);
+        }
+    }
+    SECTION("operands past the target") {
+        Number tiny = Number(1) / pow(Number(10), 700u), huge = pow(Number(10), 300u);
+        REQUIRE(product(tiny, tiny, 1000) == Number(0));
+        REQUIRE(product(tiny, huge, 300) == Number(0));
+        REQUIRE(product(tiny, huge, 1000) == tiny * huge);
+        REQUIRE(quotient(tiny, huge, 900) == Number(0));
+        REQUIRE(quotient(tiny, huge, 1000) == tiny / huge);
+        REQUIRE(quotient(Number(1), Number(3), 20).toString(30) == "0.333333333333333333333333333000");
+        REQUIRE(product(Number(6), Number("0.123456789123456789"), 9) == Number("0.740740734"));
+        REQUIRE_THROWS_AS(quotient(Number(1), Number(0), 10), std::runtime_error);
+    }
+    SECTION("magnitude") {
+        REQUIRE(Number(0).magnitude() == INT_MIN);
+        REQUIRE(Number(1).magnitude() == 0);
+        REQUIRE(Number(-999).magnitude() == 2);
+        REQUIRE(Number("1000000000").magnitude() == 9);
+        REQUIRE(Number("0.000000000123").magnitude() == -10);
+        REQUIRE(Number("0.5").magnitude() == -1);
+        REQUIRE(unit(1000).magnitude() == -1008);
+    }
+}
+
+TEST_CASE("[BigFloat accumulator]", "[All]") {
+    SECTION("matches operator+ on signed terms") {
+        int seed = GENERATE(take(10, random(0, 1000000)));
+        std::mt19937 rng(seed);
+        BigFloat sum(0);
+        BigFloatAccumulator acc;
+        for (int i = 0; i < 200; ++i) {
+            BigFloat term = BigFloat(static_cast<int>(rng() % 2000001) - 1000000) / static_cast<int>(rng() % 997 + 1);
+            if (rng() % 3 == 0) {
+                sum -= term;
+                acc -= term;
+            } else {
+                sum += term;
+                acc += term;
+            }
+        }
+        REQUIRE(acc.result() == sum);
+    }
+    SECTION("negative, zero and empty sums") {
+        BigFloatAccumulator acc;
+        REQUIRE(acc.result() == BigFloat(0));
+        acc += BigFloat("1.5");
+        acc -= BigFloat("4.25");
+        REQUIRE(acc.result() == BigFloat("-2.75"));
+        acc += BigFloat("2.75");
+        REQUIRE(acc.result().toString(2) == "0.00");
+        acc.clear();
+        acc -= pow(BigFloat(10), 40);
+        REQUIRE(acc.result() == BigFloat(0) - pow(BigFloat(10), 40));
+    }
+    SECTION("partial sums of several threads merge") {
+        std::vector<BigFloatAccumulator> partials(4);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&partials, t] {
+                for (int k = t; k < 2000; k += 4) partials[t] += BigFloat(1) / (k + 1);
+            });
+        }
+        for (auto &thread : threads) thread.join();
+        BigFloatAccumulator total, serial;
+        for (auto &partial : partials) total += partial;
+        for (int k = 0; k < 2000; ++k) serial += BigFloat(1) / (k + 1);
+        REQUIRE(total.result() == serial.result());
+    }
 }
 
 TEST_CASE("[BigFloat comparation operators]", "[All]") {
@@ -71,5 +310,757 @@ TEST_CASE("[BigFloat comparation operators]", "[All]") {
             REQUIRE(BigFloat(b) < BigFloat(a));
         }
     }
+
+    SECTION("three-way compare") {
+        BigFloat values[] = {BigFloat("-123456789012.5"), BigFloat(-1), BigFloat("-0.000000000000000001"), BigFloat(0),
+                             BigFloat("0.000000000000000001"), BigFloat("0.5"), BigFloat("0.500000000000000001"),
+                             BigFloat(1), BigFloat("1000000000"), BigFloat("123456789012.5")};
+        for (size_t i = 0; i < std::size(values); ++i) {
+            for (size_t j = 0; j < std::size(values); ++j) {
+                int expected = i < j ? -1 : i > j;
+                REQUIRE(values[i].compare(values[j]) == expected);
+                REQUIRE((values[i] < values[j]) == (expected < 0));
+                REQUIRE((values[i] <= values[j]) == (expected <= 0));
+                REQUIRE((values[i] > values[j]) == (expected > 0));
+                REQUIRE((values[i] >= values[j]) == (expected >= 0));
+                REQUIRE((values[i] == values[j]) == (expected == 0));
+            }
+        }
+        std::vector<BigFloat> sorted(std::rbegin(values), std::rend(values));
+        std::sort(sorted.begin(), sorted.end());
+        REQUIRE(std::equal(sorted.begin(), sorted.end(), std::begin(values)));
+    }
+    SECTION("zero has one sign") {
+        BigFloat x("2.5"), negativeZero("-0"), zero(0);
+        REQUIRE(negativeZero == zero);
+        REQUIRE(!(negativeZero < zero));
+        REQUIRE(!(zero < negativeZero));
+        REQUIRE((x - x).compare(zero) == 0);
+        REQUIRE((0 - x) + x == zero);
+        REQUIRE((0 - x) * 0 == zero);
+        std::string tiny = "0." + std::string(69, '0') + "1";
+        REQUIRE(BigFloat(("-" + tiny).c_str()) * BigFloat(tiny.c_str()) == zero);
+        REQUIRE((BigFloat(("-" + tiny).c_str()) * BigFloat(tiny.c_str())).toString(2) == "0.00");
+        REQUIRE((x - x).toString(2) == "0.00");
+        REQUIRE((-BigFloat(0)).toString(2) == "0.00");
+        REQUIRE((BigFloat(-3) + 3).toString(2) == "0.00");
+    }
+    SECTION("values below 1 and their top limb") {
+        BigFloat small("0.000000000000000000000000000001"), smaller("0.0000000000000000000000000000009");
+        REQUIRE(smaller < small);
+        REQUIRE(small * 2 > small);
+        REQUIRE(small / 2 < small);
+        REQUIRE(small - smaller > BigFloat(0));
+        REQUIRE(small.magnitude() == -30);
+        REQUIRE((small * 1000000000000ll).magnitude() == -18);
+    }
 }
 
+
+TEST_CASE("[BigFloat output]", "[All]") {
+    SECTION("streams match toString") {
+        BigFloat x = BigFloat(-22) / BigFloat(7);
+        std::ostringstream out;
+        out << x;
+        REQUIRE(out.str() == x.toString(135));
+        std::ostringstream shortOut;
+        x.write(shortOut, 5);
+        REQUIRE(shortOut.str() == "-3.14285");
+    }
+    SECTION("output longer than one chunk goes to a descriptor") {
+        BasicBigFloat<150000> x = BasicBigFloat<150000>(1000000) * 1000000000 / 7;
+        std::string expected = x.toString(150000);
+        REQUIRE(expected.substr(0, 20) == "142857142857142.8571");
+        std::FILE *file = std::tmpfile();
+        REQUIRE(file != nullptr);
+        x.write(fileno(file), 150000);
+        std::rewind(file);
+        std::string written(expected.size() + 1, '\0');
+        written.resize(std::fread(&written[0], 1, written.size(), file));
+        std::fclose(file);
+        REQUIRE(written == expected);
+        std::ostringstream out;
+        x.write(out, 150000);
+        REQUIRE(out.str() == expected);
+    }
+}
+
+TEST_CASE("[BigFloat serialization]", "[All]") {
+    SECTION("values round-trip") {
+        int a = GENERATE(take(10, random(-1000000, 1000000)));
+        int b = GENERATE(take(5, random(1, 1000)));
+        BigFloat x = BigFloat(a) / BigFloat(b) * BigFloat(a) * BigFloat(a);
+        BasicBigFloat<1000> y = BasicBigFloat<1000>(a) / BasicBigFloat<1000>(b);
+        std::stringstream stream;
+        x.serialize(stream);
+        y.serialize(stream);
+        BigFloat(0).serialize(stream);
+        REQUIRE(BigFloat::deserialize(stream) == x);
+        REQUIRE(BasicBigFloat<1000>::deserialize(stream) == y);
+        REQUIRE(BigFloat::deserialize(stream) == BigFloat(0));
+        //Other precisions are truncated or padded like the converting constructors
+        stream.clear();
+        stream.seekg(0);
+        REQUIRE(BasicBigFloat<9>::deserialize(stream) == BasicBigFloat<9>(x));
+        REQUIRE(BigFloat::deserialize(stream) == BigFloat(y));
+    }
+    SECTION("little-endian layout") {
+        std::ostringstream out;
+        BasicBigFloat<9>("-5.000000007").serialize(out);
+        const unsigned char expected[] = {'B', 'F', 'L', 'T', 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0,
+                                          2, 0, 0, 0, 0, 0, 0, 0, 7, 0, 0, 0, 5, 0, 0, 0};
+        REQUIRE(out.str() == std::string(reinterpret_cast<const char *>(expected), sizeof(expected)));
+    }
+    SECTION("malformed input") {
+        std::ostringstream out;
+        BigFloat(12).serialize(out);
+        std::string bytes = out.str();
+        auto read = [](const std::string &data) {
+            std::istringstream in(data);
+            return BigFloat::deserialize(in);
+        };
+        REQUIRE(read(bytes) == BigFloat(12));
+        REQUIRE_THROWS_AS(read(""), std::runtime_error);
+        REQUIRE_THROWS_AS(read(bytes.substr(0, bytes.size() - 1)), std::runtime_error);
+        REQUIRE_THROWS_AS(read("X" + bytes.substr(1)), std::runtime_error);
+        std::string newer = bytes;
+        newer[4] = 2;
+        REQUIRE_THROWS_AS(read(newer), std::runtime_error);
+        std::string overflow = bytes;
+        overflow[overflow.size() - 1] = '\x7f';
+        REQUIRE_THROWS_AS(read(overflow), std::runtime_error);
+    }
+    SECTION("mapped tables") {
+        const std::string path = "bigfloat_test_table.bin";
+        std::vector<BigFloat> values;
+        for (int i = -500; i < 500; ++i) {
+            values.push_back(BigFloat(i) / BigFloat(7) * BigFloat(i) * BigFloat(i));
+        }
+        values.push_back(BigFloat(0));
+        {
+            BigFloatTableWriter writer(path);
+            for (auto &value: values) {
+                writer.add(value.view());
+            }
+            REQUIRE_THROWS_AS(writer.add(BasicBigFloat<9>(1).view()), std::invalid_argument);
+        }
+        BigFloatTable table(path);
+        REQUIRE(table.size() == values.size());
+        for (size_t i = 0; i < values.size(); ++i) {
+            REQUIRE(table[i].toString(128) == values[i].toString(128));
+            REQUIRE(BigFloat(table[i]) == values[i]);
+        }
+        REQUIRE(BasicBigFloat<9>(table[3]) == BasicBigFloat<9>(values[3]));
+        REQUIRE_THROWS_AS(table[values.size()], std::out_of_range);
+        BigFloatTable moved(std::move(table));
+        REQUIRE(BigFloat(moved[7]) == values[7]);
+
+        BigFloatTableWriter(path).finish();
+        REQUIRE(BigFloatTable(path).size() == 0);
+        std::ofstream(path) << "not a table, just some text";
+        REQUIRE_THROWS_AS(BigFloatTable(path), std::runtime_error);
+        std::remove(path.c_str());
+        REQUIRE_THROWS_AS(BigFloatTable(path), std::system_error);
+    }
+}
+
+TEST_CASE("[BigFloat precisions]", "[All]") {
+    SECTION("converting constructors") {
+        BasicBigFloat<1000> third = BasicBigFloat<1000>(1) / BasicBigFloat<1000>(3);
+        BasicBigFloat<40> shortThird(third);
+        REQUIRE(shortThird.toString(1000) == "0.333333333333333333333333333333333333333333333");
+        REQUIRE(BasicBigFloat<1000>(shortThird) != third);
+        REQUIRE(BigFloat(BasicBigFloat<1000>(BigFloat(-7))) == BigFloat(-7));
+    }
+    SECTION("fixed and generic kernels agree") {
+        int a = GENERATE(take(10,random(-100000, 100000)));
+        int b = GENERATE(take(10,random(1, 100000)));
+        BasicBigFloat<500> x = BasicBigFloat<500>(a) / BasicBigFloat<500>(b);
+        BasicBigFloat<5000> y = BasicBigFloat<5000>(a) / BasicBigFloat<5000>(b);
+        REQUIRE((x * x).toString(400) == BasicBigFloat<500>(y * y).toString(400));
+    }
+}
+
+TEST_CASE("[BigFloat hardware conversions]", "[All]") {
+    SECTION("doubles round trip") {
+        std::mt19937_64 rng(11);
+        for (int i = 0; i < 2000; ++i) {
+            uint64_t bits = rng();
+            double x;
+            std::memcpy(&x, &bits, sizeof(x));
+            if (!std::isfinite(x)) {
+                continue;
+            }
+            //Every finite double has at most 1074 fractional digits
+            BasicBigFloat<1080> exact(x);
+            REQUIRE(exact.toDouble() == x);
+            REQUIRE(std::strtod(exact.toString(1080).c_str(), nullptr) == x);
+        }
+        for (double x : {0.0, 1.0, -2.5, 0.1, DBL_MAX, -DBL_MAX, DBL_MIN, DBL_TRUE_MIN, 9007199254740993.0}) {
+            REQUIRE(BasicBigFloat<1080>(x).toDouble() == x);
+        }
+        REQUIRE(BigFloat(0.1).toString(20) == "0.10000000000000000555");
+        REQUIRE(BigFloat(-0x1p100).toString(0) == "-1267650600228229401496703205376.");
+        REQUIRE(BigFloat(DBL_TRUE_MIN) == BigFloat(0));
+        REQUIRE_THROWS_AS(BigFloat(std::nan("")), std::domain_error);
+        REQUIRE_THROWS_AS(BigFloat(HUGE_VAL), std::domain_error);
+    }
+    SECTION("to double rounds to nearest") {
+        std::mt19937_64 rng(12);
+        for (int i = 0; i < 2000; ++i) {
+            std::string text = (rng() & 1) ? "-" : "";
+            text += std::to_string(rng() % 1000000) + ".";
+            size_t zeros = rng() % 3 == 0 ? rng() % 120 : 0;
+            for (size_t k = 0; k < 128; ++k) text += k < zeros ? '0' : static_cast<char>('0' + rng() % 10);
+            BigFloat x(text.c_str());
+            REQUIRE(x.toDouble() == std::strtod(text.c_str(), nullptr));
+            REQUIRE(std::fabs(x.estimate() - x.toDouble()) <= 1e-14 * std::fabs(x.toDouble()));
+        }
+        //Midpoints between neighbouring doubles go to the even one, anything past them to the far one
+        std::string tiny = "0." + std::string(1150, '0') + "1";
+        for (int i = 0; i < 500; ++i) {
+            double x = std::ldexp(static_cast<double>(rng() >> 11), static_cast<int>(rng() % 200) - 150);
+            double y = std::nextafter(x, HUGE_VAL);
+            BasicBigFloat<1200> mid = (BasicBigFloat<1200>(x) + BasicBigFloat<1200>(y)) / 2;
+            double even = std::fmod(std::ldexp(x, -std::ilogb(x) + 52), 2) == 0 ? x : y;
+            REQUIRE(mid.toDouble() == even);
+            REQUIRE((mid + BasicBigFloat<1200>(tiny.c_str())).toDouble() == y);
+        }
+        REQUIRE(BigFloat(("1" + std::string(400, '0')).c_str()).toDouble() == HUGE_VAL);
+        REQUIRE(BigFloat("0.5").toDouble() == 0.5);
+        REQUIRE(static_cast<double>(BigFloat("-3.25")) == -3.25);
+    }
+    SECTION("integers") {
+        for (int64_t x : {INT64_MIN, INT64_MAX, int64_t(0), int64_t(-1), int64_t(999999999), int64_t(1000000000)}) {
+            REQUIRE(BigFloat(x).toInt64() == x);
+            REQUIRE(BigFloat(x).toString(0) == std::to_string(x) + ".");
+        }
+        REQUIRE(BigFloat(UINT64_MAX).toString(0) == "18446744073709551615.");
+        REQUIRE(BigFloat("-12.99").toInt64() == -12);
+        REQUIRE(BigFloat("0.99").toInt64() == 0);
+        REQUIRE_THROWS_AS(BigFloat("9223372036854775808").toInt64(), std::overflow_error);
+        REQUIRE_THROWS_AS(BigFloat("-9223372036854775809").toInt64(), std::overflow_error);
+        REQUIRE_THROWS_AS(BigFloat("100000000000000000000000000000").toInt64(), std::overflow_error);
+        REQUIRE(BigFloat(short(-7)) * BigFloat(7u) == BigFloat(-49));
+    }
+}
+
+TEST_CASE("[Floating BigFloat]", "[All]") {
+    using Short = BasicFloatingBigFloat<9>;
+    SECTION("parsing and output") {
+        REQUIRE(FloatingBigFloat("-1.25e-3000").toString(10) == "-1.25e-3000");
+        REQUIRE(FloatingBigFloat("0.000123").toString(10) == "1.23e-4");
+        REQUIRE(FloatingBigFloat("123456789012.5").toString(5) == "1.2345e11");
+        REQUIRE(FloatingBigFloat("-0").toString(10) == "0");
+        REQUIRE(FloatingBigFloat("0.1") == FloatingBigFloat("1e-1"));
+        REQUIRE(FloatingBigFloat("-1.25e-3000").magnitude() == -3000);
+        REQUIRE(FloatingBigFloat(0).magnitude() == INT64_MIN);
+        REQUIRE_THROWS_AS(FloatingBigFloat("1e9000000000000000000"), std::overflow_error);
+    }
+    SECTION("rounding to nearest, ties to even") {
+        //Two limbs of mantissa, the limb after them decides
+        REQUIRE(Short("123456789012345678.5").toString(30) == "1.23456789012345678e17");
+        REQUIRE(Short("123456789012345679.5").toString(30) == "1.2345678901234568e17");
+        REQUIRE(Short("123456789012345678.5000000001").toString(30) == "1.23456789012345679e17");
+        REQUIRE(Short("123456789012345678.4999999999").toString(30) == "1.23456789012345678e17");
+        REQUIRE(Short("0.999999999999999999999") == Short(1));
+        //Exact quotients that fall on a tie, and one that only rounds on its remainder
+        REQUIRE(Short("246913578024691357") / Short(2) == Short("123456789012345678"));
+        REQUIRE(Short("246913578024691359") / Short(2) == Short("123456789012345680"));
+        REQUIRE(Short(2) / Short(3) == Short("0.666666666666666667"));
+        REQUIRE(Short(-2) / Short(3) == Short("-0.666666666666666667"));
+    }
+    SECTION("arithmetic independent of the magnitude") {
+        FloatingBigFloat big(1), tiny(1);
+        BigFloat exact(1);
+        for (int i = 0; i < 1000; ++i) {
+            big *= FloatingBigFloat(16);
+            tiny /= FloatingBigFloat(16);
+            exact *= 16;
+        }
+        //16^1000 has 1205 digits, all of which fit a fixed point number but only the leading ones are kept here
+        REQUIRE(big.magnitude() == 1204);
+        REQUIRE(big.toString(100) == FloatingBigFloat(exact).toString(100));
+        REQUIRE(tiny.magnitude() == -1205);
+        REQUIRE(abs(big * tiny - FloatingBigFloat(1)) < FloatingBigFloat("1e-125"));
+        REQUIRE(big + tiny == big);
+        REQUIRE(big - big == FloatingBigFloat(0));
+    }
+    SECTION("cancellation is exact") {
+        FloatingBigFloat one(1), small("1e-30");
+        REQUIRE((one + small) - one == small);
+        REQUIRE(small - (one + small) == -one);
+        REQUIRE(FloatingBigFloat("1e-100") + FloatingBigFloat("-1e-100") == FloatingBigFloat(0));
+    }
+    SECTION("comparisons") {
+        FloatingBigFloat a("-1e500"), b("-3"), c(0), d("1e-500"), e("2.5");
+        REQUIRE(a < b);
+        REQUIRE(b < c);
+        REQUIRE(c < d);
+        REQUIRE(d < e);
+        REQUIRE(e > a);
+        REQUIRE(c == -c);
+        REQUIRE(abs(b) == FloatingBigFloat(3));
+        REQUIRE(b <= b);
+        REQUIRE(b != e);
+    }
+    SECTION("conversions") {
+        BigFloat pi("3.14159265358979323846264338327950288419716939937510582097494459230781640628620899862803482534211706798214808651328230664709384460955058223172535940812848111745028410270193852110555964462294895493038196");
+        REQUIRE(FloatingBigFloat(pi).toFixed<128>() == pi);
+        REQUIRE(FloatingBigFloat(0 - pi).toFixed<128>() == 0 - pi);
+        REQUIRE(FloatingBigFloat("1e-200").toFixed<128>() == BigFloat(0));
+        REQUIRE(FloatingBigFloat("-12345.678e3").toFixed<128>() == BigFloat(-12345678));
+        REQUIRE(BasicFloatingBigFloat<1000>(FloatingBigFloat(pi)) == BasicFloatingBigFloat<1000>(pi));
+        //The mantissa is whole limbs, aligned on the limbs of the value
+        REQUIRE(Short(FloatingBigFloat(pi)).toString(30) == "3.141592654e0");
+    }
+    SECTION("division by zero") {
+        REQUIRE_THROWS_AS(FloatingBigFloat(1) / FloatingBigFloat(0), std::runtime_error);
+    }
+}
+
+TEST_CASE("[BigFloat multiplication tiers]", "[All]") {
+    const auto defaults = BigFloat::mulThresholds();
+    std::mt19937 rng(12345);
+    auto randomNumber = [&](size_t limbs) {
+        std::string digits(limbs * 9, '0');
+        for (auto &c : digits) c = static_cast<char>('0' + rng() % 10);
+        digits[0] = '1';
+        return BasicBigFloat<9>((digits + "." + std::to_string(rng() % 1000000000)).c_str());
+    };
+    auto productWith = [](BigFloat::MulThresholds thresholds, const BasicBigFloat<9> &x, const BasicBigFloat<9> &y) {
+        BigFloat::setMulThresholds(thresholds);
+        return (x * y).toString(9);
+    };
+    const BigFloat::MulThresholds naiveOnly{SIZE_MAX, SIZE_MAX, SIZE_MAX};
+    SECTION("crossovers of lowered thresholds") {
+        size_t limbs = GENERATE(14, 15, 16, 17, 62, 63, 64, 65, 130);
+        auto x = randomNumber(limbs), y = randomNumber(limbs + limbs % 3);
+        std::string expected = productWith(naiveOnly, x, y);
+        REQUIRE(productWith({16, SIZE_MAX, 64}, x, y) == expected);
+        REQUIRE(productWith({16, SIZE_MAX, SIZE_MAX}, x, y) == expected);
+        REQUIRE(productWith({16, 30, SIZE_MAX}, x, y) == expected);
+        REQUIRE(productWith({4, 9, SIZE_MAX}, x, y) == expected);
+        REQUIRE(productWith({1, 1, 1}, x, y) == expected);
+    }
+    SECTION("lowest Karatsuba cutoff") {
+        BigFloat::setMulThresholds({1, SIZE_MAX, SIZE_MAX});
+        REQUIRE(BigFloat::mulThresholds().karatsuba == 3);
+        std::string digits(1000, '0');
+        for (auto &c : digits) c = static_cast<char>('0' + rng() % 10);
+        BasicBigFloat<1000> x(("1." + digits).c_str()), y(("7" + digits).c_str());
+        std::string karatsuba = (x * y).toString(1000);
+        BigFloat::setMulThresholds(naiveOnly);
+        REQUIRE((x * y).toString(1000) == karatsuba);
+    }
+    SECTION("squares and lopsided operands") {
+        size_t limbs = GENERATE(5, 16, 17, 40, 97, 300, 700);
+        auto x = randomNumber(limbs), y = randomNumber(limbs * 3 + 7), z = randomNumber(limbs / 4 + 1);
+        std::string square = productWith(naiveOnly, x, BasicBigFloat<9>(x));
+        std::string lopsided = productWith(naiveOnly, x, y), short_ = productWith(naiveOnly, z, y);
+        for (BigFloat::MulThresholds thresholds: {defaults, BigFloat::MulThresholds{4, 9, SIZE_MAX}, BigFloat::MulThresholds{16, 40, 200},
+                                                  BigFloat::MulThresholds{8, SIZE_MAX, 32}}) {
+            BigFloat::setMulThresholds(thresholds);
+            REQUIRE((x * x).toString(9) == square);
+            REQUIRE((x * y).toString(9) == lopsided);
+            REQUIRE((y * z).toString(9) == short_);
+        }
+    }
+    SECTION("squares with full columns") {
+        //All limbs at base - 1 fill every column between two carry passes. Up to 128 limbs a naive square goes
+        //through naive_sqr, which the copy in the expected product avoids
+        for (size_t limbs : {16, 17, 18, 19, 32, 64, 128, 129}) {
+            BasicBigFloat<9> nines((std::string((limbs - 1) * 9, '9') + ".999999999").c_str());
+            auto x = randomNumber(limbs - 1);
+            std::string expected = productWith(naiveOnly, nines, BasicBigFloat<9>(nines));
+            std::string expectedRandom = productWith(naiveOnly, x, BasicBigFloat<9>(x));
+            REQUIRE((nines * nines).toString(9) == expected);
+            REQUIRE((x * x).toString(9) == expectedRandom);
+            BigFloat::setMulThresholds(defaults);
+            REQUIRE((nines * nines).toString(9) == expected);
+            REQUIRE((x * x).toString(9) == expectedRandom);
+        }
+    }
+    SECTION("tuned thresholds") {
+        auto x = randomNumber(900), y = randomNumber(650);
+        std::string expected = productWith(naiveOnly, x, y);
+        BigFloat::setMulThresholds(defaults);
+        const size_t cutoff = BigFloat::parallelCutoff();
+        auto tuned = BigFloat::tuneMulThresholds();
+        //Tuning only measures, the process-wide tiers and the parallel cutoff are left alone
+        auto current = BigFloat::mulThresholds();
+        REQUIRE(current.karatsuba == defaults.karatsuba);
+        REQUIRE(current.toom3 == defaults.toom3);
+        REQUIRE(current.ntt == defaults.ntt);
+        REQUIRE(BigFloat::parallelCutoff() == cutoff);
+        REQUIRE(tuned.karatsuba >= 1);
+        REQUIRE(productWith(tuned, x, y) == expected);
+    }
+    SECTION("default NTT crossover") {
+        size_t limbs = GENERATE_COPY(defaults.ntt - 2, defaults.ntt - 1, defaults.ntt + 1);
+        auto x = randomNumber(limbs), y = randomNumber(limbs);
+        REQUIRE(productWith(defaults, x, y) == productWith({defaults.karatsuba, defaults.toom3, SIZE_MAX}, x, y));
+    }
+    SECTION("instruction sets agree") {
+        const auto detected = BigFloat::simd();
+        size_t limbs = GENERATE(1, 7, 17, 33, 70, 300);
+        auto x = randomNumber(limbs), y = randomNumber(limbs + limbs % 5);
+        //All nines carry through every limb of a sum, the difference with them borrows through every limb
+        BasicBigFloat<9> nines(std::string(limbs * 9, '9').c_str()), one(1);
+        auto results = [&](BigFloat::Simd level) {
+            BigFloat::setSimd(level);
+            return productWith(naiveOnly, x, y) + (x + y).toString(9) + (x - y).toString(9) + (y - x).toString(9) +
+                   (nines + one).toString(9) + (nines + nines).toString(9) + ((nines + one) - one).toString(9);
+        };
+        std::string expected = results(BigFloat::Simd::Scalar);
+        REQUIRE(results(BigFloat::Simd::AVX2) == expected);
+        REQUIRE(results(BigFloat::Simd::AVX512) == expected);
+        BigFloat::setSimd(detected);
+    }
+    BigFloat::setMulThresholds(defaults);
+}
+
+TEST_CASE("[BigFloat allocations]", "[All]") {
+    SECTION("steady-state arithmetic stays off the heap") {
+        BigFloat a = 123456789.987654321_bf, b = -98765.4321_bf;
+        BigFloat c = a * b + a - b;
+        const uint64_t before = BigFloat::allocationCount();
+        for (int i = 0; i < 100; i++) {
+            c = a * b;
+            c = c + a;
+            c = c - b;
+            c = b - c;
+        }
+        REQUIRE(BigFloat::allocationCount() == before);
+        REQUIRE(c == b - (a * b + a - b));
+    }
+    SECTION("heap-backed precisions only allocate their results") {
+        //Work stolen by pool workers would leave parts of the caller's arena cold
+        const size_t cutoff = BigFloat::parallelCutoff();
+        BigFloat::setParallelCutoff(SIZE_MAX);
+        BasicBigFloat<5000> x(1), y(3);
+        x = x / y;
+        y = x * x;
+        const uint64_t before = BigFloat::allocationCount();
+        for (int i = 0; i < 10; i++) {
+            y = x * x;
+        }
+        REQUIRE(BigFloat::allocationCount() - before == 10);
+
+        //Accumulation in place reuses the storage of the accumulator
+        BasicBigFloat<5000> acc = x * x;
+        acc += x;
+        acc *= x;
+        const uint64_t beforeLoop = BigFloat::allocationCount();
+        for (int i = 0; i < 10; i++) {
+            acc += x;
+            acc -= y;
+            acc *= x;
+            acc = std::move(acc) + y;
+        }
+        REQUIRE(BigFloat::allocationCount() == beforeLoop);
+
+        //Small integers take a single allocation
+        const uint64_t beforeInt = BigFloat::allocationCount();
+        BasicBigFloat<5000> small(-1234567890);
+        REQUIRE(BigFloat::allocationCount() - beforeInt == 1);
+        REQUIRE(small * x == x * BasicBigFloat<5000>("-1234567890"));
+        BigFloat::setParallelCutoff(cutoff);
+    }
+}
+
+TEST_CASE("[BigFloat statistics]", "[All]") {
+    SECTION("counters follow the build flag") {
+        BasicBigFloat<5000> x(1), y(7);
+        x = x / y;
+        BigFloat::resetStats();
+        y = x * x;
+        x = x / y;
+        BigFloat::Stats stats = BigFloat::stats();
+        if (BigFloat::statsEnabled) {
+            REQUIRE(stats.division.calls > 0);
+            REQUIRE(stats.karatsubaMul.calls + stats.toom3Mul.calls + stats.nttMul.calls > 0);
+            REQUIRE(stats.naiveMul.calls > 0);
+            REQUIRE(stats.newtonSteps > 0);
+            REQUIRE(stats.carryPasses > 0);
+            REQUIRE(stats.allocations > 0);
+            BigFloat::resetStats();
+            REQUIRE(BigFloat::stats().division.calls == 0);
+        } else {
+            REQUIRE(stats.division.calls == 0);
+            REQUIRE(stats.naiveMul.calls == 0);
+            REQUIRE(stats.newtonSteps == 0);
+            REQUIRE(stats.allocations == 0);
+        }
+    }
+    SECTION("diagnostics go to the sink") {
+        std::vector<std::string> messages;
+        BigFloat::setDiagnosticSink([&](const std::string &message) { messages.push_back(message); });
+        REQUIRE_THROWS_AS(BigFloat(1) / BigFloat(0), std::runtime_error);
+        REQUIRE(messages == std::vector<std::string>{"Division by zero"});
+        BigFloat::setDiagnosticSink({});
+        REQUIRE_THROWS_AS(BigFloat(1) / BigFloat(0), std::runtime_error);
+        REQUIRE(messages.size() == 1);
+    }
+}
+
+TEST_CASE("[BigFloat task pool]", "[All]") {
+    const auto thresholds = BigFloat::mulThresholds();
+    const size_t cutoff = BigFloat::parallelCutoff();
+    const unsigned workers = BigFloat::workerCount();
+    std::mt19937 rng(777);
+    auto randomNumber = [&](size_t limbs) {
+        std::string digits(limbs * 9, '0');
+        for (auto &c : digits) c = static_cast<char>('0' + rng() % 10);
+        digits[0] = '1';
+        return BasicBigFloat<9>(digits.c_str());
+    };
+    auto x = randomNumber(3000), y = randomNumber(2100);
+    BigFloat::setWorkerCount(0);
+    std::string karatsuba = (x * y).toString(0);
+    BigFloat::setMulThresholds({thresholds.karatsuba, thresholds.toom3, 64});
+    std::string ntt = (x * y).toString(0);
+    REQUIRE(ntt == karatsuba);
+
+    BigFloat::setWorkerCount(4);
+    BigFloat::setParallelCutoff(64);
+    SECTION("split products match serial ones") {
+        BigFloat::setMulThresholds({thresholds.karatsuba, thresholds.toom3, SIZE_MAX});
+        REQUIRE((x * y).toString(0) == karatsuba);
+        BigFloat::setMulThresholds({thresholds.karatsuba, thresholds.toom3, 64});
+        REQUIRE((x * y).toString(0) == ntt);
+    }
+    SECTION("callers that are already parallel") {
+        BigFloat::setMulThresholds({thresholds.karatsuba, thresholds.toom3, SIZE_MAX});
+        std::vector<std::string> results(6);
+        std::vector<std::thread> callers;
+        for (auto &result: results) {
+            callers.emplace_back([&] { result = (x * y).toString(0); });
+        }
+        for (auto &caller: callers) {
+            caller.join();
+        }
+        for (auto &result: results) {
+            REQUIRE(result == karatsuba);
+        }
+    }
+    SECTION("forked tasks finish before an error leaves their frame") {
+        std::atomic<int> finished{0};
+        auto slow = [&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            ++finished;
+        };
+        auto failing = [&] {
+            ++finished;
+            throw std::runtime_error("task");
+        };
+        auto first = TaskPool::task(slow);
+        auto second = TaskPool::task(failing);
+        REQUIRE_THROWS_AS([&] {
+            TaskPool::Group group;
+            group.fork(first);
+            group.fork(second);
+            throw std::domain_error("frame");
+        }(), std::domain_error);
+        REQUIRE(finished == 2);
+        auto third = TaskPool::task(slow);
+        auto fourth = TaskPool::task(failing);
+        TaskPool::Group group;
+        group.fork(third);
+        group.fork(fourth);
+        REQUIRE_THROWS_AS(group.join(), std::runtime_error);
+        REQUIRE(finished == 4);
+    }
+    BigFloat::setMulThresholds(thresholds);
+    BigFloat::setParallelCutoff(cutoff);
+    BigFloat::setWorkerCount(workers);
+}
+
+TEST_CASE("[Parallel series]", "[All]") {
+    const unsigned workers = BigFloat::workerCount();
+    unsigned count = GENERATE(0u, 4u);
+    BigFloat::setWorkerCount(count);
+    SECTION("stateless terms") {
+        REQUIRE(parallelSeries<128>(0, 10000, [](uint64_t k) { return BigFloat(static_cast<int>(k)); }) == BigFloat(49995000));
+        REQUIRE(parallelSeries<128>(5, 5, [](uint64_t k) { return BigFloat(static_cast<int>(k)); }) == BigFloat(0));
+        BigFloat harmonic = parallelSeries<128>(1, 1001, [](uint64_t k) { return BigFloat(1) / k; });
+        BigFloat serial(0);
+        for (int k = 1; k <= 1000; ++k) {
+            serial += BigFloat(1) / k;
+        }
+        REQUIRE(harmonic == serial);
+    }
+    SECTION("chunks carry their state") {
+        //BBP series for pi, every chunk starts its running power 16^-k once and divides it down from there
+        BigFloat pi = parallelSeries<128>(0, 120, [](uint64_t k) { return BigFloat(1) / pow(BigFloat(16), k); },
+                                          [](BigFloat &power, uint64_t k) {
+            BigFloat term = power * (BigFloat(4) / (8 * k + 1) - BigFloat(2) / (8 * k + 4) -
+                                     BigFloat(1) / (8 * k + 5) - BigFloat(1) / (8 * k + 6));
+            power /= 16;
+            return term;
+        });
+        REQUIRE(pi.toString(120) == PiEngine::digits(120));
+    }
+    SECTION("errors of terms reach the caller") {
+        auto failing = [](uint64_t k) {
+            if (k == 777) {
+                throw std::domain_error("term 777");
+            }
+            return BigFloat(1);
+        };
+        REQUIRE_THROWS_AS(parallelSeries<128>(0, 1000, failing), std::domain_error);
+    }
+    BigFloat::setWorkerCount(workers);
+}
+
+TEST_CASE("[BigFloat array]", "[All]") {
+    const unsigned workers = BigFloat::workerCount();
+    const size_t cutoff = BigFloat::parallelCutoff();
+    unsigned count = GENERATE(0u, 4u);
+    BigFloat::setWorkerCount(count);
+    BigFloat::setParallelCutoff(64);
+    //Products of two values are exact at twice the fractional digits
+    using Wide = BasicBigFloat<270>;
+    std::mt19937 rng(2025);
+    auto randomNumber = [&] {
+        std::string digits = rng() % 2 ? "-" : "";
+        size_t intDigits = rng() % 4 == 0 ? 1 + rng() % 40 : 1;
+        for (size_t i = 0; i < intDigits + 128; ++i) digits += static_cast<char>('0' + rng() % 10);
+        digits.insert(digits.size() - 128, ".");
+        return rng() % 16 == 0 ? BigFloat(0) : BigFloat(digits.c_str());
+    };
+    const size_t n = 3000;
+    std::vector<BigFloat> x, y, z;
+    for (size_t i = 0; i < n; ++i) {
+        x.push_back(randomNumber());
+        y.push_back(rng() % 8 == 0 ? BigFloat(0) - x[i] : randomNumber());
+        z.push_back(randomNumber());
+    }
+    BigFloatArray a(x), b(y), c(z), res;
+
+    SECTION("elements are shared with the BigFloat API") {
+        REQUIRE(a.size() == n);
+        for (size_t i = 0; i < n; ++i) {
+            REQUIRE(a[i] == x[i]);
+            REQUIRE(BigFloat(a.view(i)) == x[i]);
+        }
+        REQUIRE(a.view(1).toString(128) == x[1].toString(128));
+        BigFloat huge("123456789012345678901234567890123456789012345678901234567890.5");
+        a.set(7, huge);
+        a.push_back(BigFloat(0) - huge);
+        REQUIRE(a.size() == n + 1);
+        REQUIRE(a[7] == huge);
+        REQUIRE(a[n] == BigFloat(0) - huge);
+        REQUIRE(a[0] == x[0]);
+        a.resize(n + 3);
+        REQUIRE(a[n + 2] == BigFloat(0));
+        REQUIRE(BigFloatArray(5)[4] == BigFloat(0));
+    }
+    SECTION("element-wise operations match BigFloat ones") {
+        BigFloatArray::add(res, a, b);
+        for (size_t i = 0; i < n; ++i) REQUIRE(res[i] == x[i] + y[i]);
+        BigFloatArray::sub(res, a, b);
+        for (size_t i = 0; i < n; ++i) REQUIRE(res[i] == x[i] - y[i]);
+        BigFloatArray::mul(res, a, b);
+        for (size_t i = 0; i < n; ++i) REQUIRE(res[i] == x[i] * y[i]);
+        //Results may replace their operands
+        BigFloatArray::add(a, a, a);
+        for (size_t i = 0; i < n; ++i) REQUIRE(a[i] == x[i] + x[i]);
+        BigFloatArray::mul(b, b, c);
+        for (size_t i = 0; i < n; ++i) REQUIRE(b[i] == y[i] * z[i]);
+    }
+    SECTION("fused operations truncate once") {
+        BigFloatArray::fma(res, a, b, c);
+        for (size_t i = 0; i < n; ++i) REQUIRE(res[i] == BigFloat(Wide(x[i]) * Wide(y[i]) + Wide(z[i])));
+        BigFloat alpha("-3.14159265358979323846264338327950288419716939937510582097494459230781640628620899862803482534211706798");
+        BigFloatArray::axpy(c, alpha, a);
+        for (size_t i = 0; i < n; ++i) REQUIRE(c[i] == BigFloat(Wide(alpha) * Wide(x[i]) + Wide(z[i])));
+        Wide exact(0);
+        for (size_t i = 0; i < n; ++i) exact += Wide(x[i]) * Wide(y[i]);
+        REQUIRE(BigFloatArray::dot(a, b) == BigFloat(exact));
+        REQUIRE(BigFloatArray::dot(BigFloatArray(), BigFloatArray()) == BigFloat(0));
+    }
+    SECTION("repeated updates keep the slots narrow") {
+        BigFloatArray sum(n);
+        for (int k = 0; k < 20; ++k) BigFloatArray::add(sum, sum, c);
+        for (size_t i = 0; i < n; ++i) REQUIRE(sum[i] == z[i] * 20);
+        REQUIRE(sum.view(0).size() <= BigFloatArray::fracLimbs + 7);
+    }
+    SECTION("operands of different sizes") {
+        REQUIRE_THROWS_AS(BigFloatArray::add(res, a, BigFloatArray(n - 1)), std::invalid_argument);
+        REQUIRE_THROWS_AS(BigFloatArray::dot(a, BigFloatArray(1)), std::invalid_argument);
+    }
+    BigFloat::setParallelCutoff(cutoff);
+    BigFloat::setWorkerCount(workers);
+}
+
+TEST_CASE("[Pi engine]", "[All]") {
+    const std::string first100 = "3.1415926535897932384626433832795028841971693993751058209749445923078164062862089986280348253421170679";
+    SECTION("both series give the known digits") {
+        auto series = GENERATE(PiSeries::Chudnovsky, PiSeries::BBP);
+        std::string pi = PiEngine::digits(1000, series);
+        REQUIRE(pi.size() == 1002);
+        REQUIRE(pi.substr(0, 102) == first100);
+        //Six nines starting at the 762nd digit
+        REQUIRE(pi.substr(763, 6) == "999999");
+        REQUIRE(pi.substr(992) == "2164201989");
+        REQUIRE(PiEngine::digits(9, series) == "3.141592653");
+    }
+    SECTION("series agree on long expansions") {
+        REQUIRE(PiEngine::digits(20000, PiSeries::Chudnovsky) == PiEngine::digits(20000, PiSeries::BBP));
+    }
+    SECTION("BigFloat values") {
+        REQUIRE(PiEngine::pi<128>().toString(100) == first100);
+        REQUIRE(PiEngine::pi<9>() == BasicBigFloat<9>("3.141592653"));
+    }
+}
+
+TEST_CASE("[Constants cache]", "[All]") {
+    using Constant = BigFloat::Constant;
+    SECTION("known digits") {
+        REQUIRE(Constants::pi<100>().toString(100) == PiEngine::digits(100));
+        REQUIRE(Constants::e<100>().toString(100) == "2.7182818284590452353602874713526624977572470936999595749669676277240766303535475945713821785251664274");
+        REQUIRE(Constants::ln2<100>().toString(100) == "0.6931471805599453094172321214581765680755001343602552541206800094933936219696947156058633269964186875");
+        REQUIRE(Constants::sqrt2<100>().toString(100) == "1.4142135623730950488016887242096980785696718753769480731766797379907324784621070388503875343276415727");
+        REQUIRE(Constants::e<1000>() == exp(BasicBigFloat<1000>(1)));
+        REQUIRE(Constants::ln2<1000>() == log(BasicBigFloat<1000>(2)));
+        REQUIRE(Constants::sqrt2<1000>() == sqrt(BasicBigFloat<1000>(2)));
+    }
+    SECTION("lower precisions are truncations") {
+        auto c = GENERATE(Constant::Pi, Constant::E, Constant::Ln2, Constant::Sqrt2);
+        size_t limbs = Constants::cachedLimbs(c) + 50;
+        std::vector<uint32_t> wide = Constants::fixedPoint(c, limbs);
+        REQUIRE(Constants::cachedLimbs(c) == limbs);
+        std::vector<uint32_t> narrow = Constants::fixedPoint(c, 7);
+        REQUIRE(std::equal(narrow.begin(), narrow.end(), wide.end() - narrow.size(), wide.end()));
+        REQUIRE(Constants::cachedLimbs(c) == limbs);
+    }
+    SECTION("concurrent first requests") {
+        size_t limbs = Constants::cachedLimbs(Constant::E) + 300;
+        std::vector<std::vector<uint32_t>> results(6);
+        std::vector<std::thread> callers;
+        for (auto &result: results) {
+            callers.emplace_back([&] { result = Constants::fixedPoint(Constant::E, limbs); });
+        }
+        for (auto &caller: callers) {
+            caller.join();
+        }
+        for (auto &result: results) {
+            REQUIRE(result == PiEngine::eFixedPoint(limbs));
+        }
+        REQUIRE(Constants::cachedLimbs(Constant::E) == limbs);
+    }
+    SECTION("preloaded digits") {
+        size_t limbs = Constants::cachedLimbs(Constant::Pi) + 100;
+        std::string path = "constants_test_pi.txt";
+        std::ofstream(path) << PiEngine::digits(limbs * 9 + 5) << '\n';
+        Constants::preload(Constant::Pi, path);
+        REQUIRE(Constants::cachedLimbs(Constant::Pi) == limbs);
+        REQUIRE(Constants::fixedPoint(Constant::Pi, limbs) == PiEngine::fixedPoint(limbs));
+        std::ofstream(path) << "3.14x";
+        REQUIRE_THROWS_AS(Constants::preload(Constant::Pi, path), std::runtime_error);
+        std::remove(path.c_str());
+        REQUIRE_THROWS_AS(Constants::preload(Constant::Pi, path), std::runtime_error);
+        REQUIRE(Constants::cachedLimbs(Constant::Pi) == limbs);
+    }
+}